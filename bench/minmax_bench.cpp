@@ -0,0 +1,450 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <optional>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+#include <array>
+
+#include "minmax_engine.hpp"
+#include "search_stats.hpp"
+#include "search_trace.hpp"
+#include "tic_tac_toe.hpp"
+#include "connect4.hpp"
+#include "connect_n.hpp"
+#include "perft.hpp"
+
+// Runs the engine at fixed depths over the positions listed in `positions.txt` and checks
+// every best move and score against the reference stored there: any difference makes the
+// benchmark fail, so that performance work can't silently change what the engine plays.
+// The boards and the engine get checked first (see `BENCH_CHECKS`), failing it just the same.
+
+#ifndef MINMAX_BENCH_POSITIONS
+#define MINMAX_BENCH_POSITIONS "positions.txt"
+#endif
+
+static constexpr int POSITIONS_FORMAT_VERSION = 1;
+
+struct BenchReference {
+    long long best_move = 0;
+    long long score = 0;
+};
+
+struct BenchPosition {
+    std::string game;
+    size_t depth = 0;
+    std::vector<long long> moves;
+    std::optional<BenchReference> reference;
+};
+
+struct BenchOptions {
+    std::string positions_path = MINMAX_BENCH_POSITIONS;
+    size_t thread_count = 1;
+    size_t repetitions = 1;
+    SearchMode search_mode = SearchMode::ALPHA_BETA;
+    bool write_reference = false;
+
+    // when set, every position is searched once more with a tracer, and its trace written to
+    // `<prefix>-<n>.trace` (`n` counting positions from 1): see `tools/search_trace_report.cpp`
+    std::string trace_prefix;
+
+    // when set, every position is searched once more with `PlainMinimaxPolicy`, which must find
+    // the same move and score, and whose throughput gets reported next to the usual one: it
+    // visits every node up to the given depth, so it's best restricted to the smaller games
+    bool plain_minimax = false;
+
+    // only the positions of this game get searched (all of them when empty)
+    std::string game;
+};
+
+struct BenchResult {
+    BenchReference found;
+    size_t nodes_visited = 0;
+    double seconds = 0;
+};
+
+[[nodiscard]] static std::vector<long long> parse_moves(const std::string& text) {
+    std::vector<long long> moves;
+    if (text == "-") {
+        return moves;
+    }
+    std::stringstream stream(text);
+    std::string move;
+    while (std::getline(stream, move, ',')) {
+        moves.push_back(std::stoll(move));
+    }
+    return moves;
+}
+
+[[nodiscard]] static std::string format_moves(const std::vector<long long>& moves) {
+    if (moves.empty()) {
+        return "-";
+    }
+    std::string text;
+    for (size_t index = 0; index < moves.size(); index++) {
+        if (index != 0) {
+            text += ',';
+        }
+        text += std::to_string(moves[index]);
+    }
+    return text;
+}
+
+// one position per line: `<game> <depth> <moves> [<best move> <score>]`, where moves are
+// comma separated and played from the initial board (`-` for the initial board itself)
+[[nodiscard]] static std::vector<BenchPosition> load_positions(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Error: cannot open positions file " + path);
+    }
+    std::vector<BenchPosition> positions;
+    std::string line;
+    bool version_checked = false;
+    while (std::getline(file, line)) {
+        if (line.empty() || line.front() == '#') {
+            continue;
+        }
+        std::stringstream stream(line);
+        if (!version_checked) {
+            std::string keyword;
+            int version = 0;
+            stream >> keyword >> version;
+            if (keyword != "version" || version != POSITIONS_FORMAT_VERSION) {
+                throw std::runtime_error("Error: unsupported positions file version in " + path);
+            }
+            version_checked = true;
+            continue;
+        }
+        BenchPosition position;
+        std::string moves;
+        if (!(stream >> position.game >> position.depth >> moves)) {
+            throw std::runtime_error("Error: malformed position `" + line + "`");
+        }
+        position.moves = parse_moves(moves);
+        BenchReference reference;
+        if (stream >> reference.best_move >> reference.score) {
+            position.reference = reference;
+        }
+        positions.push_back(position);
+    }
+    return positions;
+}
+
+static void copy_comments(const std::string& path, std::ostream& stream) {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (!line.empty() && line.front() == '#') {
+            stream << line << "\n";
+        }
+    }
+}
+
+// The solved table would answer every tic-tac-toe position right at the root, leaving nothing
+// of the search itself to measure or check: tic-tac-toe gets benchmarked without it, and the
+// table is used as the oracle the search must agree with instead
+template <search_stats_policy Stats>
+struct UnsolvedSearchPolicy : DefaultSearchPolicy<Stats> {
+    static constexpr bool SOLVED_POSITIONS = false;
+};
+
+static_assert(search_policy<UnsolvedSearchPolicy<SearchStats>>);
+
+// every position reachable from the empty board gets searched to the end of the game, and
+// both its score and the one of the move found must be the perfect-play score of the position
+[[nodiscard]] static bool tic_tac_toe_matches_solution(const BenchOptions& options) {
+    static constexpr size_t TRANSPOSITION_TABLE_CAPACITY = 4096;
+    SearchEngine<TicTacToeBoard::score_t, TicTacToeBoard, UnsolvedSearchPolicy<NoSearchStats>> engine(
+        TRANSPOSITION_TABLE_CAPACITY
+    );
+    engine.thread_count = options.thread_count;
+    engine.search_mode = options.search_mode;
+    const TicTacToeSolution& solution = TicTacToeSolution::instance();
+    std::vector<bool> visited(tic_tac_toe_geometry::POSITIONS_COUNT);
+    std::vector<TicTacToeBoard> pending { TicTacToeBoard() };
+    while (!pending.empty()) {
+        TicTacToeBoard board = pending.back();
+        pending.pop_back();
+        auto moves = board.moves();
+        if (visited[board.hash()] || moves.empty()) {
+            continue;
+        }
+        visited[board.hash()] = true;
+        engine.clear();
+        auto analysis = engine.analyze(9 - board.depth, board);
+        auto expected = solution.score_of(board);
+        if (analysis.score != expected || solution.score_of(analysis.best_move) != expected) {
+            return false;
+        }
+        for (TicTacToeBoard::move_t move : moves) {
+            pending.push_back(board.make(move));
+        }
+    }
+    return true;
+}
+
+struct BenchCheck {
+    const char* name;
+    bool (*passes)(const BenchOptions&);
+};
+
+// the boards being benchmarked and the engine itself, against independent implementations
+static const std::array<BenchCheck, 3> BENCH_CHECKS = {{
+    { "connect4 perft against the array board", [](const BenchOptions&) {
+        return perft(Connect4Board(), 6) == perft(Connect4BitBoard(), 6);
+    } },
+    { "connect-n perft references", [](const BenchOptions&) {
+        return connect_n_perft_matches_references();
+    } },
+    { "tic-tac-toe search against the solved positions", tic_tac_toe_matches_solution },
+}};
+
+[[nodiscard]] static size_t run_checks(const BenchOptions& options, std::ostream& report) {
+    size_t failures = 0;
+    for (const BenchCheck& check : BENCH_CHECKS) {
+        bool passes = check.passes(options);
+        report << "check: " << check.name << " " << ((passes) ? "ok" : "FAILED") << "\n";
+        failures += !passes;
+    }
+    return failures;
+}
+
+// boards that can't generate moves get played on the board they wrap (see `Connect4ArenaBoard`)
+template <game_board Board>
+[[nodiscard]] static Board play_moves(const std::vector<long long>& moves) {
+    if constexpr (!move_generating_game_board<Board>) {
+        return Board(play_moves<typename Board::board_t>(moves));
+    }
+    else {
+        Board board;
+        for (long long move : moves) {
+            auto legal_moves = board.moves();
+            if (std::find(legal_moves.begin(), legal_moves.end(), move) == legal_moves.end()) {
+                throw std::runtime_error("Error: illegal move " + std::to_string(move) + " in a bench position");
+            }
+            board = board.make(static_cast<typename Board::move_t>(move));
+        }
+        return board;
+    }
+}
+
+// the traced search is not timed, recording the nodes slows it down
+template <game_board Board, template <typename> typename Policy>
+static void trace_position(
+    const Board& board, const BenchPosition& position, const BenchOptions& options, const std::string& path
+) {
+    using Score = typename Board::score_t;
+    SearchEngine<Score, Board, Policy<SearchTracer<Score>>> engine;
+    engine.thread_count = options.thread_count;
+    engine.search_mode = options.search_mode;
+    [[maybe_unused]] auto analysis = engine.analyze(position.depth, board);
+    write_search_trace(path, engine.stats);
+}
+
+// every repetition starts from a cold engine, the fastest one is reported
+template <game_board Board, template <typename> typename Policy = DefaultSearchPolicy>
+[[nodiscard]] static BenchResult run_position(
+    const BenchPosition& position, const BenchOptions& options, const std::string& trace_path
+) {
+    using Engine = SearchEngine<typename Board::score_t, Board, Policy<SearchStats>>;
+    Board board = play_moves<Board>(position.moves);
+    BenchResult result;
+    for (size_t repetition = 0; repetition < options.repetitions; repetition++) {
+        Engine engine;
+        engine.thread_count = options.thread_count;
+        engine.search_mode = options.search_mode;
+        auto start_time = std::chrono::steady_clock::now();
+        auto analysis = engine.analyze(position.depth, board);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        if (repetition == 0 || seconds < result.seconds) {
+            result.seconds = seconds;
+        }
+        result.found = BenchReference { analysis.best_move.get_prev_move(), static_cast<long long>(analysis.score) };
+        result.nodes_visited = engine.stats.nodes_visited;
+    }
+    if (!trace_path.empty()) {
+        trace_position<Board, Policy>(board, position, options, trace_path);
+    }
+    return result;
+}
+
+// plain minimax searches are never traced, their trees are just the full trees
+template <game_board Board, template <typename> typename Policy = DefaultSearchPolicy>
+[[nodiscard]] static BenchResult run_position_with(
+    const BenchPosition& position, const BenchOptions& options, const std::string& trace_path, bool plain_minimax
+) {
+    return (plain_minimax)
+        ? run_position<Board, PlainMinimaxPolicy>(position, options, std::string())
+        : run_position<Board, Policy>(position, options, trace_path);
+}
+
+[[nodiscard]] static BenchResult run_position(
+    const BenchPosition& position, const BenchOptions& options, const std::string& trace_path, bool plain_minimax
+) {
+    if (position.game == "tic_tac_toe") {
+        return run_position_with<TicTacToeBoard, UnsolvedSearchPolicy>(position, options, trace_path, plain_minimax);
+    }
+    if (position.game == "tic_tac_toe_float") {
+        return run_position_with<FloatTicTacToeBoard>(position, options, trace_path, plain_minimax);
+    }
+    if (position.game == "connect4") {
+        return run_position_with<Connect4BitBoard>(position, options, trace_path, plain_minimax);
+    }
+    if (position.game == "connect4_arena") {
+        return run_position_with<Connect4ArenaBoard>(position, options, trace_path, plain_minimax);
+    }
+    if (position.game == "connect4_7x6") {
+        return run_position_with<Connect4StandardBoard>(position, options, trace_path, plain_minimax);
+    }
+    throw std::runtime_error("Error: unknown game `" + position.game + "`");
+}
+
+// "ok" when the result matches the reference of the position (if it has one)
+[[nodiscard]] static std::string check_result(const BenchPosition& position, const BenchResult& result, size_t& failures) {
+    if (!position.reference.has_value()) {
+        return "-";
+    }
+    bool matches = position.reference->best_move == result.found.best_move
+                && position.reference->score == result.found.score;
+    failures += !matches;
+    return (matches) ? "ok" : "FAILED (expected " + std::to_string(position.reference->best_move)
+                            + " " + std::to_string(position.reference->score) + ")";
+}
+
+[[nodiscard]] static BenchOptions parse_options(int argc, char** argv) {
+    BenchOptions options;
+    for (int index = 1; index < argc; index++) {
+        std::string argument = argv[index];
+        bool has_value = index + 1 < argc;
+        if (argument == "--positions" && has_value) {
+            options.positions_path = argv[++index];
+        }
+        else if (argument == "--threads" && has_value) {
+            options.thread_count = std::stoul(argv[++index]);
+        }
+        else if (argument == "--repeat" && has_value) {
+            options.repetitions = std::max<size_t>(std::stoul(argv[++index]), 1);
+        }
+        else if (argument == "--pvs") {
+            options.search_mode = SearchMode::PRINCIPAL_VARIATION;
+        }
+        else if (argument == "--write-reference") {
+            options.write_reference = true;
+        }
+        else if (argument == "--trace" && has_value) {
+            options.trace_prefix = argv[++index];
+        }
+        else if (argument == "--plain") {
+            options.plain_minimax = true;
+        }
+        else if (argument == "--game" && has_value) {
+            options.game = argv[++index];
+        }
+        else {
+            throw std::runtime_error(
+                "usage: minmax_bench [--positions <file>] [--threads <n>] "
+                "[--repeat <n>] [--pvs] [--write-reference] [--trace <prefix>] [--plain] [--game <name>]"
+            );
+        }
+    }
+    return options;
+}
+
+// with `--write-reference` the positions file is printed back with the results of this run
+// as references, the usual report goes to stderr so that stdout can be redirected to a file
+int main(int argc, char** argv) {
+    try {
+        BenchOptions options = parse_options(argc, argv);
+        std::vector<BenchPosition> positions = load_positions(options.positions_path);
+        std::ostream& report = (options.write_reference) ? std::cerr : std::cout;
+        if (options.write_reference) {
+            copy_comments(options.positions_path, std::cout);
+            std::cout << "version " << POSITIONS_FORMAT_VERSION << "\n";
+        }
+
+        size_t failures = run_checks(options, report);
+        report << std::left << std::setw(19) << "game" << std::setw(7) << "depth" << std::setw(40) << "moves"
+               << std::right << std::setw(6) << "best" << std::setw(13) << "score" << std::setw(12) << "nodes"
+               << std::setw(11) << "ms" << std::setw(14) << "nodes/sec";
+        if (options.plain_minimax) {
+            report << std::setw(14) << "plain nodes" << std::setw(14) << "plain n/sec";
+        }
+        report << "  check\n";
+
+        size_t total_nodes = 0;
+        double total_seconds = 0;
+        size_t total_plain_nodes = 0;
+        double total_plain_seconds = 0;
+        for (size_t index = 0; index < positions.size(); index++) {
+            const BenchPosition& position = positions[index];
+            if (!options.game.empty() && position.game != options.game) {
+                if (options.write_reference) {
+                    std::cout << position.game << " " << position.depth << " " << format_moves(position.moves);
+                    if (position.reference.has_value()) {
+                        std::cout << " " << position.reference->best_move << " " << position.reference->score;
+                    }
+                    std::cout << "\n";
+                }
+                continue;
+            }
+            std::string trace_path = (options.trace_prefix.empty())
+                ? std::string()
+                : options.trace_prefix + "-" + std::to_string(index + 1) + ".trace";
+            BenchResult result = run_position(position, options, trace_path, false);
+            total_nodes += result.nodes_visited;
+            total_seconds += result.seconds;
+            std::string check = check_result(position, result, failures);
+
+            std::optional<BenchResult> plain_result;
+            if (options.plain_minimax) {
+                plain_result = run_position(position, options, std::string(), true);
+                total_plain_nodes += plain_result->nodes_visited;
+                total_plain_seconds += plain_result->seconds;
+                std::string plain_check = check_result(position, *plain_result, failures);
+                if (plain_check != "ok" && plain_check != "-") {
+                    check += ", plain minimax " + plain_check + " (found " + std::to_string(plain_result->found.best_move)
+                           + " " + std::to_string(plain_result->found.score) + ")";
+                }
+            }
+            report << std::left << std::setw(19) << position.game << std::setw(7) << position.depth
+                   << std::setw(40) << format_moves(position.moves) << std::right
+                   << std::setw(6) << result.found.best_move << std::setw(13) << result.found.score
+                   << std::setw(12) << result.nodes_visited
+                   << std::setw(11) << std::fixed << std::setprecision(2) << result.seconds * 1000
+                   << std::setw(14) << std::setprecision(0) << result.nodes_visited / result.seconds;
+            if (plain_result.has_value()) {
+                report << std::setw(14) << plain_result->nodes_visited
+                       << std::setw(14) << std::setprecision(0) << plain_result->nodes_visited / plain_result->seconds;
+            }
+            report << "  " << check << "\n";
+
+            if (options.write_reference) {
+                std::cout << position.game << " " << position.depth << " " << format_moves(position.moves)
+                          << " " << result.found.best_move << " " << result.found.score << "\n";
+            }
+        }
+
+        report << "total: " << total_nodes << " nodes in " << std::setprecision(2) << total_seconds * 1000
+               << " ms (" << std::setprecision(0) << total_nodes / total_seconds << " nodes/sec), "
+               << failures << " failed checks and reference mismatches\n";
+        if (options.plain_minimax) {
+            report << "plain minimax: " << total_plain_nodes << " nodes in " << std::setprecision(2)
+                   << total_plain_seconds * 1000 << " ms (" << std::setprecision(0)
+                   << total_plain_nodes / total_plain_seconds << " nodes/sec)\n";
+        }
+        return (failures == 0 || options.write_reference) ? 0 : 1;
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 2;
+    }
+}
@@ -0,0 +1,482 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <stdexcept>
+#include <cstdint>
+#include <cstdlib>
+#include <bit>
+#include <ostream>
+#include <optional>
+#include <utility>
+#include <span>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define CONNECT_N_AVX2_DISPATCH 1
+#endif
+
+#include "minmax_engine.hpp"
+#include "move_list.hpp"
+#include "perft.hpp"
+
+namespace connect_n_lanes {
+
+    // Positions after each move of the same player, one per lane and stored as structure of
+    // arrays, so that they can be evaluated side by side: `mover` holds the pieces of the player
+    // who just moved, `tops` the topmost piece of every column. Unused lanes are left empty.
+    template <size_t Size>
+    struct LeafLanes {
+        static_assert(Size % 4 == 0, "Error: lanes are evaluated four at a time");
+
+        static constexpr size_t SIZE = Size;
+
+        alignas(32) std::array<uint64_t, SIZE> mover{};
+        alignas(32) std::array<uint64_t, SIZE> opponent{};
+        alignas(32) std::array<uint64_t, SIZE> tops{};
+        alignas(32) std::array<uint64_t, SIZE> empty{};
+
+        // whether the mover connected `Length` pieces, and its heuristic reward minus the opponent's
+        alignas(32) std::array<uint64_t, SIZE> won{};
+        alignas(32) std::array<int64_t, SIZE> balance{};
+    };
+
+    template <typename Board, size_t Size>
+    void evaluate_lanes_scalar(LeafLanes<Size>& lanes, size_t count) {
+        for (size_t lane = 0; lane < count; lane++) {
+            lanes.won[lane] = Board::has_n_in_a_row(lanes.mover[lane]);
+            lanes.balance[lane] = Board::top_rewards(lanes.mover[lane], lanes.tops[lane], lanes.empty[lane])
+                                - Board::top_rewards(lanes.opponent[lane], lanes.tops[lane], lanes.empty[lane]);
+        }
+    }
+
+#ifdef CONNECT_N_AVX2_DISPATCH
+
+    // per 64-bit lane population count: nibbles are looked up in a table, then summed by lane
+    __attribute__((target("avx2"))) inline __m256i popcount_lanes(__m256i value) {
+        const __m256i table = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+        );
+        const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+        __m256i low = _mm256_shuffle_epi8(table, _mm256_and_si256(value, low_nibbles));
+        __m256i high = _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi64(value, 4), low_nibbles));
+        return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+    }
+
+    // same doubling as `ConnectNBoard::runs_of`, four lanes at a time
+    template <int Shift, int RunLength>
+    __attribute__((target("avx2"))) inline __m256i runs_of_lanes(__m256i mask) {
+        if constexpr (RunLength == 1) {
+            return mask;
+        }
+        else if constexpr (RunLength % 2 == 0) {
+            __m256i halves = runs_of_lanes<Shift, RunLength / 2>(mask);
+            return _mm256_and_si256(halves, _mm256_srli_epi64(halves, RunLength / 2 * Shift));
+        }
+        else {
+            return _mm256_and_si256(runs_of_lanes<Shift, RunLength - 1>(mask), _mm256_srli_epi64(mask, (RunLength - 1) * Shift));
+        }
+    }
+
+    template <typename Board>
+    __attribute__((target("avx2"))) inline __m256i top_rewards_lanes(__m256i player_mask, __m256i tops, __m256i empty) {
+        __m256i player_tops = _mm256_and_si256(player_mask, tops);
+        __m256i inner_tops = _mm256_and_si256(player_tops, _mm256_set1_epi64x(Board::INNER_COLUMNS_MASK));
+        __m256i left = _mm256_and_si256(inner_tops, _mm256_srli_epi64(empty, Board::COLUMN_STRIDE));
+        __m256i right = _mm256_and_si256(inner_tops, _mm256_slli_epi64(empty, Board::COLUMN_STRIDE));
+        __m256i above = _mm256_and_si256(player_tops, _mm256_set1_epi64x(Board::NOT_TOP_ROW_MASK));
+        return _mm256_add_epi64(_mm256_add_epi64(popcount_lanes(left), popcount_lanes(right)), popcount_lanes(above));
+    }
+
+    template <typename Board, size_t Size>
+    __attribute__((target("avx2"))) void evaluate_lanes_avx2(LeafLanes<Size>& lanes) {
+        constexpr auto directions = Board::DIRECTIONS;
+        constexpr int length = Board::LENGTH;
+        for (size_t lane = 0; lane < Size; lane += 4) {
+            __m256i mover = _mm256_load_si256(reinterpret_cast<const __m256i*>(&lanes.mover[lane]));
+            __m256i opponent = _mm256_load_si256(reinterpret_cast<const __m256i*>(&lanes.opponent[lane]));
+            __m256i tops = _mm256_load_si256(reinterpret_cast<const __m256i*>(&lanes.tops[lane]));
+            __m256i empty = _mm256_load_si256(reinterpret_cast<const __m256i*>(&lanes.empty[lane]));
+            __m256i lines = _mm256_or_si256(
+                _mm256_or_si256(runs_of_lanes<directions[0], length>(mover), runs_of_lanes<directions[1], length>(mover)),
+                _mm256_or_si256(runs_of_lanes<directions[2], length>(mover), runs_of_lanes<directions[3], length>(mover))
+            );
+            __m256i won = _mm256_andnot_si256(
+                _mm256_cmpeq_epi64(lines, _mm256_setzero_si256()), _mm256_set1_epi64x(1)
+            );
+            __m256i balance = _mm256_sub_epi64(
+                top_rewards_lanes<Board>(mover, tops, empty), top_rewards_lanes<Board>(opponent, tops, empty)
+            );
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&lanes.won[lane]), won);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(&lanes.balance[lane]), balance);
+        }
+    }
+
+#endif
+
+    // AVX2 when the processor running the program supports it, whatever it was compiled for
+    template <typename Board, size_t Size>
+    void evaluate_lanes(LeafLanes<Size>& lanes, size_t count) {
+#ifdef CONNECT_N_AVX2_DISPATCH
+        static const bool avx2_supported = __builtin_cpu_supports("avx2");
+        if (avx2_supported) {
+            evaluate_lanes_avx2<Board>(lanes);
+            return;
+        }
+#endif
+        evaluate_lanes_scalar<Board>(lanes, count);
+    }
+}
+
+// Connect-n on `Columns` x `Rows` boards where `Length` pieces in a row win, backed by two
+// bitboards (one per player). Each column takes `Rows + 1` bits (the playable rows plus an
+// always-empty sentinel on top), so bit `col * (Rows + 1) + row` is the slot at (row, col) and
+// lines can be detected by shifting and and-ing the masks. Everything that depends on the
+// geometry (masks, shifts, zobrist keys) is computed at compile time, and the win check gets
+// unrolled for each instantiation into the same few shifts and ands a hand-written board would
+// use: `ConnectNBoard<6, 5, 4>` is the board of `connect4.hpp`, `ConnectNBoard<7, 6, 4>` the
+// standard game. The zobrist key and the game status are updated incrementally by `make()`.
+template <int Columns, int Rows, int Length>
+struct ConnectNBoard {
+
+    using score_t = int;
+    using move_t = int;
+    using depth_t = int;
+
+    enum class GameStatus {
+        INCOMPLETE,
+        DRAW,
+        X_WIN,
+        O_WIN,
+    };
+
+    static constexpr int COLUMNS = Columns;
+    static constexpr int ROWS = Rows;
+    static constexpr int LENGTH = Length;
+    static constexpr int COLUMN_STRIDE = ROWS + 1;
+
+    static_assert(COLUMNS >= 1 && ROWS >= 1 && LENGTH >= 2, "Error: degenerate connect-n geometry");
+    static_assert(COLUMNS * COLUMN_STRIDE <= 64, "Error: the board (plus a sentinel row) must fit in 64 bits");
+    static_assert(COLUMNS <= 64 && COLUMNS * ROWS <= 255, "Error: moves and heights wouldn't fit their types");
+
+    // vertical, falling diagonal, horizontal, rising diagonal
+    static constexpr std::array<int, 4> DIRECTIONS = { 1, COLUMN_STRIDE - 1, COLUMN_STRIDE, COLUMN_STRIDE + 1 };
+
+    static constexpr uint64_t bit_at(int row, int col) {
+        return uint64_t(1) << (col * COLUMN_STRIDE + row);
+    }
+
+    static constexpr uint64_t make_mask(int first_row, int last_row, int first_col, int last_col) {
+        uint64_t mask = 0;
+        for (int col = first_col; col <= last_col; col++) {
+            for (int row = first_row; row <= last_row; row++) {
+                mask |= bit_at(row, col);
+            }
+        }
+        return mask;
+    }
+
+    static constexpr uint64_t PLAYABLE_MASK = make_mask(0, ROWS - 1, 0, COLUMNS - 1);
+    static constexpr uint64_t INNER_COLUMNS_MASK = make_mask(0, ROWS - 1, 1, COLUMNS - 2);
+    static constexpr uint64_t NOT_TOP_ROW_MASK = make_mask(0, ROWS - 2, 0, COLUMNS - 1);
+    static constexpr uint64_t COLUMN_MASK = make_mask(0, COLUMN_STRIDE - 1, 0, 0);
+
+    static constexpr auto ZOBRIST_KEYS = [] {
+        std::array<std::array<uint64_t, COLUMNS * COLUMN_STRIDE>, 2> keys{};
+        uint64_t state = 0x9e3779b97f4a7c15ULL;
+        for (auto& player_keys : keys) {
+            for (auto& key : player_keys) {
+                uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                key = z ^ (z >> 31);
+            }
+        }
+        return keys;
+    }();
+
+    static const move_t INITIAL_MOVE = -1;
+
+    depth_t depth = 0;
+    move_t prev_move = INITIAL_MOVE;
+    uint64_t x_mask = 0;
+    uint64_t o_mask = 0;
+    uint64_t zobrist_key = 0;
+    std::array<uint8_t, COLUMNS> heights{};
+    GameStatus status = GameStatus::INCOMPLETE;
+
+    ConnectNBoard() noexcept = default;
+    ConnectNBoard(const ConnectNBoard&) noexcept = default;
+    ConnectNBoard(ConnectNBoard&&) noexcept = default;
+
+    ConnectNBoard& operator=(const ConnectNBoard& other) = default;
+    ConnectNBoard& operator=(ConnectNBoard&& other) = default;
+
+    bool operator==(const ConnectNBoard& other) const noexcept = delete;
+    bool operator!=(const ConnectNBoard& other) const noexcept = delete;
+
+    static void ensure(bool condition) {
+        if (!condition) {
+            throw std::runtime_error("Error: illegal state of the connect-n board");
+        }
+    }
+
+    // slots starting a run of `RunLength` pieces along `Shift`: runs get doubled up while
+    // they fit, then topped up with the missing pieces, so four takes two shifts and five three
+    template <int Shift, int RunLength>
+    [[nodiscard]] static constexpr uint64_t runs_of(uint64_t mask) {
+        if constexpr (RunLength == 1) {
+            return mask;
+        }
+        else if constexpr (RunLength % 2 == 0) {
+            uint64_t halves = runs_of<Shift, RunLength / 2>(mask);
+            return halves & (halves >> (RunLength / 2 * Shift));
+        }
+        else {
+            return runs_of<Shift, RunLength - 1>(mask) & (mask >> ((RunLength - 1) * Shift));
+        }
+    }
+
+    [[nodiscard]] static constexpr bool has_n_in_a_row(uint64_t mask) {
+        static_assert((LENGTH - 1) * (COLUMN_STRIDE + 1) < 64);
+        return (runs_of<DIRECTIONS[0], LENGTH>(mask) | runs_of<DIRECTIONS[1], LENGTH>(mask)
+              | runs_of<DIRECTIONS[2], LENGTH>(mask) | runs_of<DIRECTIONS[3], LENGTH>(mask)) != 0;
+    }
+
+    [[nodiscard]] GameStatus compute_game_status() const {
+        return status;
+    }
+
+    // a top piece is rewarded for each free horizontal neighbour (inner columns only)
+    // and for the free slot right above it (unless it lies on the top row)
+    [[nodiscard]] static int top_rewards(uint64_t player_mask, uint64_t tops, uint64_t empty) {
+        uint64_t player_tops = player_mask & tops;
+        uint64_t inner_tops = player_tops & INNER_COLUMNS_MASK;
+        return std::popcount(inner_tops & (empty >> COLUMN_STRIDE))
+             + std::popcount(inner_tops & (empty << COLUMN_STRIDE))
+             + std::popcount(player_tops & NOT_TOP_ROW_MASK);
+    }
+
+    [[nodiscard]] score_t evaluate() const {
+        switch (compute_game_status()) {
+            case GameStatus::DRAW:  return 0;
+            case GameStatus::X_WIN: return score_traits<score_t>::win_in(depth);
+            case GameStatus::O_WIN: return score_traits<score_t>::loss_in(depth);
+            case GameStatus::INCOMPLETE: break;
+        }
+
+        uint64_t top_pieces = this->top_pieces();
+        uint64_t empty = PLAYABLE_MASK & ~(x_mask | o_mask);
+        return top_rewards(x_mask, top_pieces, empty) - top_rewards(o_mask, top_pieces, empty);
+    }
+
+    [[nodiscard]] uint64_t top_pieces() const {
+        uint64_t top_pieces = 0;
+        for (int col = 0; col < COLUMNS; col++) {
+            if (heights[col] != 0) {
+                top_pieces |= bit_at(heights[col] - 1, col);
+            }
+        }
+        return top_pieces;
+    }
+
+    // the position after each move is laid out in a lane of its own, then all of them get
+    // evaluated at once (see `connect_n_lanes::evaluate_lanes`) with the same scores
+    // `make(move).evaluate()` would give
+    [[nodiscard]] uint64_t evaluate_children(std::span<score_t> scores) const {
+        auto moves = this->moves();
+        bool x_to_move = current_player_is_maximizing();
+        uint64_t mover = x_to_move ? x_mask : o_mask;
+        uint64_t opponent = x_to_move ? o_mask : x_mask;
+        uint64_t parent_tops = top_pieces();
+        uint64_t parent_empty = PLAYABLE_MASK & ~(x_mask | o_mask);
+        connect_n_lanes::LeafLanes<(COLUMNS + 3) / 4 * 4> lanes;
+        for (size_t lane = 0; lane < moves.size(); lane++) {
+            int column = moves[lane];
+            uint64_t piece = bit_at(heights[column], column);
+            lanes.mover[lane] = mover | piece;
+            lanes.opponent[lane] = opponent;
+            lanes.tops[lane] = (parent_tops & ~(COLUMN_MASK << (column * COLUMN_STRIDE))) | piece;
+            lanes.empty[lane] = parent_empty & ~piece;
+        }
+        connect_n_lanes::evaluate_lanes<ConnectNBoard>(lanes, moves.size());
+        depth_t child_depth = depth + 1;
+        uint64_t ongoing_games = 0;
+        for (size_t lane = 0; lane < moves.size(); lane++) {
+            if (lanes.won[lane]) {
+                scores[lane] = x_to_move ? score_traits<score_t>::win_in(child_depth) : score_traits<score_t>::loss_in(child_depth);
+            }
+            else if (child_depth == COLUMNS * ROWS) {
+                scores[lane] = 0;
+            }
+            else {
+                scores[lane] = static_cast<score_t>(x_to_move ? lanes.balance[lane] : -lanes.balance[lane]);
+                ongoing_games |= uint64_t(1) << lane;
+            }
+        }
+        return ongoing_games;
+    }
+
+    [[nodiscard]] std::optional<GameOutcome> outcome() const {
+        switch (status) {
+            case GameStatus::DRAW:  return GameOutcome::DRAW;
+            case GameStatus::X_WIN: return GameOutcome::MAXIMIZING_PLAYER_WINS;
+            case GameStatus::O_WIN: return GameOutcome::MINIMIZING_PLAYER_WINS;
+            case GameStatus::INCOMPLETE: break;
+        }
+        return std::nullopt;
+    }
+
+    [[nodiscard]] size_t remaining_plies() const {
+        return COLUMNS * ROWS - depth;
+    }
+
+    [[nodiscard]] MoveList<move_t, COLUMNS> moves() const {
+        MoveList<move_t, COLUMNS> moves;
+        if (compute_game_status() != GameStatus::INCOMPLETE) {
+            return moves;
+        }
+        for (move_t move = 0; move < COLUMNS; move++) {
+            if (heights[move] < ROWS) {
+                moves.push_back(move);
+            }
+        }
+        return moves;
+    }
+
+    // central columns take part in more lines, so they get searched first
+    [[nodiscard]] int move_priority(move_t move) const {
+        return -std::abs(2 * move - (COLUMNS - 1));
+    }
+
+    // a move that wins on the spot, or else every move that keeps the opponent from winning
+    // on the next one (all the others lose right away); quiet positions have none
+    [[nodiscard]] MoveList<move_t, COLUMNS> forcing_moves() const {
+        MoveList<move_t, COLUMNS> forcing_moves;
+        if (compute_game_status() != GameStatus::INCOMPLETE) {
+            return forcing_moves;
+        }
+        bool x_to_move = current_player_is_maximizing();
+        uint64_t mover = x_to_move ? x_mask : o_mask;
+        uint64_t opponent = x_to_move ? o_mask : x_mask;
+        for (move_t move = 0; move < COLUMNS; move++) {
+            if (heights[move] < ROWS && has_n_in_a_row(mover | bit_at(heights[move], move))) {
+                forcing_moves.push_back(move);
+                return forcing_moves;
+            }
+        }
+        for (move_t move = 0; move < COLUMNS; move++) {
+            if (heights[move] < ROWS && has_n_in_a_row(opponent | bit_at(heights[move], move))) {
+                forcing_moves.push_back(move);
+            }
+        }
+        return forcing_moves;
+    }
+
+    [[nodiscard]] std::vector<ConnectNBoard> children() const {
+        std::vector<ConnectNBoard> children;
+        children.reserve(COLUMNS);
+        for (move_t move : moves()) {
+            children.emplace_back(this->make(move));
+        }
+        return children;
+    }
+
+    [[nodiscard]] uint64_t hash() const {
+        return zobrist_key;
+    }
+
+    [[nodiscard]] move_t get_prev_move() const {
+        return prev_move;
+    }
+
+    [[nodiscard]] ConnectNBoard make(move_t move) const {
+        ensure(move >= 0 && move < COLUMNS);
+        ensure(heights[move] < ROWS);
+        ConnectNBoard new_board = *this;
+        bool x_to_move = current_player_is_maximizing();
+        uint64_t& player_mask = x_to_move ? new_board.x_mask : new_board.o_mask;
+        int bit_index = move * COLUMN_STRIDE + heights[move];
+        player_mask |= uint64_t(1) << bit_index;
+        new_board.zobrist_key ^= ZOBRIST_KEYS[x_to_move ? 0 : 1][bit_index];
+        new_board.heights[move]++;
+        new_board.depth = depth + 1;
+        new_board.prev_move = move;
+        if (has_n_in_a_row(player_mask)) {
+            new_board.status = x_to_move ? GameStatus::X_WIN : GameStatus::O_WIN;
+        }
+        else if (new_board.depth == COLUMNS * ROWS) {
+            new_board.status = GameStatus::DRAW;
+        }
+        return new_board;
+    }
+
+    [[nodiscard]] bool current_player_is_maximizing() const {
+        return depth % 2 == 0;
+    }
+
+    friend std::ostream& operator<<(std::ostream& stream, const ConnectNBoard& board) {
+        for(int row = ROWS; row != 0; row--) {
+            stream << "|";
+            for (int col = 0; col < COLUMNS; col++) {
+                uint64_t slot = bit_at(row - 1, col);
+                if (board.x_mask & slot)      stream << " X |";
+                else if (board.o_mask & slot) stream << " O |";
+                else                          stream << "   |";
+            }
+            stream << "\n";
+        }
+        stream << "\n\n";
+        return stream;
+    }
+};
+
+// Move sequences of exactly `depth` plies from the empty board, as counted by an independent
+// brute-force implementation: a geometry that's gotten wrong (a shift, a mask, a line that
+// wraps around the board edge) shows up here as soon as the first wins become possible
+struct ConnectNPerftReference {
+    int columns;
+    int rows;
+    int length;
+    size_t depth;
+    size_t nodes;
+};
+
+constexpr std::array<ConnectNPerftReference, 5> CONNECT_N_PERFT_REFERENCES = {{
+    { 4, 4, 3, 9,  122884 },
+    { 5, 4, 3, 8,  269032 },
+    { 6, 5, 4, 7,  279720 },
+    { 7, 6, 4, 7,  823536 },
+    { 5, 6, 5, 9, 1950060 },
+}};
+
+template <ConnectNPerftReference Reference>
+[[nodiscard]] bool connect_n_perft_matches() {
+    return perft(ConnectNBoard<Reference.columns, Reference.rows, Reference.length>(), Reference.depth) == Reference.nodes;
+}
+
+// each reference instantiates (and checks) a board of its own geometry
+[[nodiscard]] inline bool connect_n_perft_matches_references() {
+    return []<size_t... Indices>(std::index_sequence<Indices...>) {
+        return (connect_n_perft_matches<CONNECT_N_PERFT_REFERENCES[Indices]>() && ...);
+    }(std::make_index_sequence<CONNECT_N_PERFT_REFERENCES.size()>());
+}
+
+using Connect4StandardBoard = ConnectNBoard<7, 6, 4>;
+
+static_assert(game_board<Connect4StandardBoard>);
+static_assert(hashable_game_board<Connect4StandardBoard>);
+static_assert(move_generating_game_board<Connect4StandardBoard>);
+static_assert(move_ordering_game_board<Connect4StandardBoard>);
+static_assert(solvable_game_board<Connect4StandardBoard>);
+static_assert(batch_evaluating_game_board<Connect4StandardBoard>);
+static_assert(quiescent_game_board<Connect4StandardBoard>);
+static_assert(ConnectNBoard<7, 6, 4>::has_n_in_a_row(0b1111) && !ConnectNBoard<7, 6, 4>::has_n_in_a_row(0b111));
+static_assert(!ConnectNBoard<7, 6, 4>::has_n_in_a_row(0b10111000)); // can't go through the sentinel
+using Connect4StandardEngine = MinMaxEngine<Connect4StandardBoard::score_t, Connect4StandardBoard>;
@@ -0,0 +1,345 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <stdexcept>
+#include <algorithm>
+#include <numeric>
+#include <optional>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <ostream>
+
+#include "minmax_engine.hpp"
+#include "move_list.hpp"
+
+namespace tic_tac_toe_geometry {
+
+    constexpr std::array<uint16_t, 8> WINNING_LINES = {
+        0b000'000'111, 0b000'111'000, 0b111'000'000,  // rows
+        0b001'001'001, 0b010'010'010, 0b100'100'100,  // columns
+        0b100'010'001, 0b001'010'100,                 // diagonals
+    };
+
+    // whether a set of squares (one bit per square, the first one being the least significant)
+    // contains a whole line, for all the 512 possible sets
+    constexpr std::array<bool, 512> CONTAINS_LINE = [] {
+        std::array<bool, 512> table{};
+        for (uint16_t squares = 0; squares < 512; squares++) {
+            for (uint16_t line : WINNING_LINES) {
+                table[squares] |= (squares & line) == line;
+            }
+        }
+        return table;
+    }();
+
+    // contribution of a set of squares to the base-3 index of a board, as if every square
+    // in the set held a 1: the index of a board is then `TERNARY[x] + 2 * TERNARY[o]`
+    constexpr std::array<uint16_t, 512> TERNARY = [] {
+        std::array<uint16_t, 512> table{};
+        for (uint16_t squares = 0; squares < 512; squares++) {
+            uint16_t power = 1;
+            for (int square = 8; square >= 0; square--) {
+                table[squares] += ((squares >> square) & 1) * power;
+                power *= 3;
+            }
+        }
+        return table;
+    }();
+
+    constexpr size_t POSITIONS_COUNT = 19683; // 3^9
+}
+
+struct TicTacToeBoard {
+
+    using depth_t = int;
+    using score_t = int;
+    using move_t = int;
+
+    enum class Square {
+        EMPTY,
+        OCCUPIED_X,
+        OCCUPIED_O
+    };
+
+    static const move_t INITIAL_MOVE = -1;
+
+    // the board is packed in two sets of squares, one per player, with square `i` in bit `i`
+    depth_t depth = 0;
+    move_t prev_move = INITIAL_MOVE;
+    uint16_t x_mask = 0;
+    uint16_t o_mask = 0;
+
+    explicit TicTacToeBoard(const std::array<Square, 9> internal) {
+        for (size_t square = 0; square < 9; square++) {
+            x_mask |= uint16_t(internal[square] == Square::OCCUPIED_X) << square;
+            o_mask |= uint16_t(internal[square] == Square::OCCUPIED_O) << square;
+        }
+        ensure(std::popcount(o_mask) <= std::popcount(x_mask));
+    }
+
+    TicTacToeBoard() = default;
+    TicTacToeBoard(const TicTacToeBoard&) noexcept = default;
+    TicTacToeBoard(TicTacToeBoard&&) noexcept = default;
+
+    TicTacToeBoard& operator=(const TicTacToeBoard& other) = default;
+    TicTacToeBoard& operator=(TicTacToeBoard&& other) = default;
+
+    bool operator==(const TicTacToeBoard& other) const noexcept = delete;
+    bool operator!=(const TicTacToeBoard& other) const noexcept = delete;
+
+    static void ensure(bool condition) {
+        if (!condition) {
+            throw std::runtime_error("Error: illegal state of the tic-tac-toe board");
+        }
+    }
+
+    [[nodiscard]] Square square_at(size_t square) const {
+        if ((x_mask >> square) & 1) {
+            return Square::OCCUPIED_X;
+        }
+        if ((o_mask >> square) & 1) {
+            return Square::OCCUPIED_O;
+        }
+        return Square::EMPTY;
+    }
+
+    [[nodiscard]] score_t evaluate() const {
+        if (tic_tac_toe_geometry::CONTAINS_LINE[x_mask]) {
+            return score_traits<score_t>::win_in(depth);
+        }
+        if (tic_tac_toe_geometry::CONTAINS_LINE[o_mask]) {
+            return score_traits<score_t>::loss_in(depth);
+        }
+        return 0;
+    }
+
+    [[nodiscard]] MoveList<move_t, 9> moves() const {
+        MoveList<move_t, 9> moves;
+        if (tic_tac_toe_geometry::CONTAINS_LINE[x_mask] || tic_tac_toe_geometry::CONTAINS_LINE[o_mask]) {
+            return moves;
+        }
+        for (move_t i = 0; i < 9; i++) {
+            if (!(((x_mask | o_mask) >> i) & 1)) {
+                moves.push_back(i);
+            }
+        }
+        return moves;
+    }
+
+    // the center lies on four lines, corners on three and edges on two
+    [[nodiscard]] int move_priority(move_t move) const {
+        static constexpr std::array<int, 9> lines_through = {3, 2, 3, 2, 4, 2, 3, 2, 3};
+        return lines_through[move];
+    }
+
+    [[nodiscard]] std::vector<TicTacToeBoard> children() const {
+        std::vector<TicTacToeBoard> children;
+        for (move_t move : moves()) {
+            children.emplace_back(this->make(move));
+        }
+        return children;
+    }
+
+    // base-3 index of the board, every square being a digit (the first one the most significant)
+    [[nodiscard]] uint64_t hash() const {
+        return tic_tac_toe_geometry::TERNARY[x_mask] + 2 * tic_tac_toe_geometry::TERNARY[o_mask];
+    }
+
+    // exact score under perfect play of both players, see `TicTacToeSolution`
+    [[nodiscard]] std::optional<score_t> solved_score() const;
+
+    [[nodiscard]] move_t get_prev_move() const {
+        return prev_move;
+    }
+
+    [[nodiscard]] TicTacToeBoard make(move_t move) const {
+        ensure(move >= 0 && move <= 8 && !(((x_mask | o_mask) >> move) & 1));
+        TicTacToeBoard new_board = *this;
+        uint16_t& player_mask = current_player_is_maximizing() ? new_board.x_mask : new_board.o_mask;
+        player_mask |= uint16_t(1) << move;
+        new_board.prev_move = move;
+        new_board.depth = depth + 1;
+        return new_board;
+    }
+
+    [[nodiscard]] bool current_player_is_maximizing() const {
+        return std::popcount(x_mask) <= std::popcount(o_mask);
+    }
+
+    friend std::ostream& operator<<(std::ostream& stream, const TicTacToeBoard& board) {
+        std::string structure =
+                "+---+---+---+ \n"
+                "| @ | @ | @ | \n"
+                "+---+---+---+ \n"
+                "| @ | @ | @ | \n"
+                "+---+---+---+ \n"
+                "| @ | @ | @ | \n"
+                "+---+---+---+ \n";
+
+        uint8_t counter = 0;
+        for (char& c : structure) {
+            if (c == '@') {
+                switch (board.square_at(counter++)) {
+                    break; case Square::OCCUPIED_X: c = 'X';
+                    break; case Square::OCCUPIED_O: c = 'O';
+                    break; case Square::EMPTY:      c = ' ';
+                }
+            }
+        }
+
+        stream << structure << "\n";
+        return stream;
+    }
+};
+
+// Perfect-play outcome of every position reachable from the empty board, solved once on first
+// use (a few milliseconds, 20KB). Outcomes don't depend on how many moves led to the position,
+// so they are stored relative to it: 0 for a draw, `10 - n` when X wins `n` moves later and
+// `n - 10` when O does, which orders them the same way as the scores they stand for.
+class TicTacToeSolution {
+
+    static constexpr int8_t UNSOLVED = INT8_MIN;
+    static constexpr int8_t WIN_BASE = 10;
+
+    std::array<int8_t, tic_tac_toe_geometry::POSITIONS_COUNT> outcomes;
+
+    int8_t solve(const TicTacToeBoard& board) {
+        int8_t& outcome = outcomes[board.hash()];
+        if (outcome != UNSOLVED) {
+            return outcome;
+        }
+        if (tic_tac_toe_geometry::CONTAINS_LINE[board.x_mask]) {
+            return outcome = WIN_BASE;
+        }
+        if (tic_tac_toe_geometry::CONTAINS_LINE[board.o_mask]) {
+            return outcome = -WIN_BASE;
+        }
+        auto moves = board.moves();
+        if (moves.empty()) {
+            return outcome = 0;
+        }
+        bool maximizing = board.current_player_is_maximizing();
+        int8_t best = (maximizing) ? -WIN_BASE : WIN_BASE;
+        for (TicTacToeBoard::move_t move : moves) {
+            int8_t child = solve(board.make(move));
+            // one more move to go before the win
+            child -= (child > 0) - (child < 0);
+            best = (maximizing) ? std::max(best, child) : std::min(best, child);
+        }
+        return outcome = best;
+    }
+
+    TicTacToeSolution() {
+        outcomes.fill(UNSOLVED);
+        solve(TicTacToeBoard());
+    }
+
+public:
+
+    [[nodiscard]] static const TicTacToeSolution& instance() {
+        static const TicTacToeSolution solution;
+        return solution;
+    }
+
+    // same scale as `TicTacToeBoard::evaluate()`, as if the game was played to the end;
+    // positions that can't be reached from the empty board are not solved
+    [[nodiscard]] std::optional<TicTacToeBoard::score_t> score_of(const TicTacToeBoard& board) const {
+        using score_t = TicTacToeBoard::score_t;
+        int8_t outcome = outcomes[board.hash()];
+        if (outcome == UNSOLVED) {
+            return std::nullopt;
+        }
+        if (outcome > 0) {
+            return score_traits<score_t>::win_in(board.depth + WIN_BASE - outcome);
+        }
+        if (outcome < 0) {
+            return score_traits<score_t>::loss_in(board.depth + WIN_BASE + outcome);
+        }
+        return 0;
+    }
+};
+
+inline std::optional<TicTacToeBoard::score_t> TicTacToeBoard::solved_score() const {
+    return TicTacToeSolution::instance().score_of(*this);
+}
+
+// Same game scored in floating point, as a learned evaluator would: wins and losses are put
+// on the `score_traits<float>` mate scale (the integer one can't be represented exactly), and
+// there's no solved table, so the generic search is all the engine has to go on
+struct FloatTicTacToeBoard {
+
+    using depth_t = TicTacToeBoard::depth_t;
+    using score_t = float;
+    using move_t = TicTacToeBoard::move_t;
+
+    TicTacToeBoard board;
+
+    FloatTicTacToeBoard() = default;
+
+    explicit FloatTicTacToeBoard(const TicTacToeBoard& board) : board(board) {}
+
+    [[nodiscard]] score_t evaluate() const {
+        if (tic_tac_toe_geometry::CONTAINS_LINE[board.x_mask]) {
+            return score_traits<score_t>::win_in(board.depth);
+        }
+        if (tic_tac_toe_geometry::CONTAINS_LINE[board.o_mask]) {
+            return score_traits<score_t>::loss_in(board.depth);
+        }
+        return 0;
+    }
+
+    [[nodiscard]] MoveList<move_t, 9> moves() const {
+        return board.moves();
+    }
+
+    [[nodiscard]] int move_priority(move_t move) const {
+        return board.move_priority(move);
+    }
+
+    [[nodiscard]] std::vector<FloatTicTacToeBoard> children() const {
+        std::vector<FloatTicTacToeBoard> children;
+        for (move_t move : moves()) {
+            children.emplace_back(this->make(move));
+        }
+        return children;
+    }
+
+    [[nodiscard]] uint64_t hash() const {
+        return board.hash();
+    }
+
+    [[nodiscard]] move_t get_prev_move() const {
+        return board.get_prev_move();
+    }
+
+    [[nodiscard]] FloatTicTacToeBoard make(move_t move) const {
+        return FloatTicTacToeBoard(board.make(move));
+    }
+
+    [[nodiscard]] bool current_player_is_maximizing() const {
+        return board.current_player_is_maximizing();
+    }
+
+    friend std::ostream& operator<<(std::ostream& stream, const FloatTicTacToeBoard& board) {
+        return stream << board.board;
+    }
+};
+
+static_assert(game_board<TicTacToeBoard>);
+static_assert(hashable_game_board<TicTacToeBoard>);
+static_assert(move_generating_game_board<TicTacToeBoard>);
+static_assert(move_ordering_game_board<TicTacToeBoard>);
+static_assert(solved_game_board<TicTacToeBoard>);
+static_assert(game_board<FloatTicTacToeBoard>);
+static_assert(hashable_game_board<FloatTicTacToeBoard>);
+static_assert(move_ordering_game_board<FloatTicTacToeBoard>);
+static_assert(!solved_game_board<FloatTicTacToeBoard>);
+using TicTacToeEngine = MinMaxEngine<TicTacToeBoard::score_t, TicTacToeBoard>;
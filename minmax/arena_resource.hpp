@@ -0,0 +1,79 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <memory_resource>
+#include <vector>
+
+// Bump allocator that only gives memory back all at once through `reset`: unlike
+// `std::pmr::monotonic_buffer_resource::release` the blocks it got from the upstream
+// resource are kept, so after warming up it serves every allocation without touching it
+class ArenaResource : public std::pmr::memory_resource {
+
+    static constexpr size_t INITIAL_BLOCK_SIZE = 4096;
+
+    struct Block {
+        std::byte* data;
+        size_t size;
+    };
+
+    std::pmr::memory_resource* upstream;
+    std::vector<Block> blocks;
+    size_t current_block = 0;
+    size_t offset = 0;
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        while (current_block < blocks.size()) {
+            const Block& block = blocks[current_block];
+            size_t aligned_offset = (offset + alignment - 1) / alignment * alignment;
+            if (aligned_offset + bytes <= block.size) {
+                offset = aligned_offset + bytes;
+                return block.data + aligned_offset;
+            }
+            current_block++;
+            offset = 0;
+        }
+        size_t size = std::max({ bytes + alignment, INITIAL_BLOCK_SIZE, 2 * (blocks.empty() ? 0 : blocks.back().size) });
+        auto* data = static_cast<std::byte*>(upstream->allocate(size, alignof(std::max_align_t)));
+        blocks.push_back(Block { data, size });
+        current_block = blocks.size() - 1;
+        offset = 0;
+        return do_allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+
+    explicit ArenaResource(std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+        : upstream(upstream)
+    {}
+
+    ArenaResource(const ArenaResource&) = delete;
+    ArenaResource& operator=(const ArenaResource&) = delete;
+
+    ~ArenaResource() override {
+        for (const Block& block : blocks) {
+            upstream->deallocate(block.data, block.size, alignof(std::max_align_t));
+        }
+    }
+
+    // everything allocated so far must be dead by now
+    void reset() {
+        current_block = 0;
+        offset = 0;
+    }
+
+    [[nodiscard]] std::pmr::memory_resource* upstream_resource() const {
+        return upstream;
+    }
+};
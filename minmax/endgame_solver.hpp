@@ -0,0 +1,270 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <array>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "game_board.hpp"
+#include "transposition_table.hpp"
+#include "search_stats.hpp"
+
+// Proves the exact outcome of a position instead of estimating it: the search never stops at
+// a horizon and never calls `evaluate()`, every line is followed until the game is over. The
+// winner is assumed to win as fast as possible and the loser to resist as long as possible, so
+// a decisive result also comes with its distance to mate. Only null windows are searched, which
+// is what makes a full-depth search affordable: `prove` settles win/draw/loss with at most two
+// of them, `solve` narrows down the exact distance to mate by bisection.
+template <solvable_game_board Board, search_stats_policy Stats = NoSearchStats>
+struct EndgameSolver {
+
+    static constexpr bool USES_TRANSPOSITION_TABLE = hashable_game_board<Board>;
+    static constexpr bool USES_BOARD_HINTS = move_ordering_game_board<Board>;
+
+    using SolverScore = int32_t;
+
+    using TranspositionTableType = std::conditional_t<
+        USES_TRANSPOSITION_TABLE,
+        TranspositionTable<SolverScore>,
+        NoTranspositionTable
+    >;
+
+    [[no_unique_address]] TranspositionTableType transposition_table;
+    [[no_unique_address]] Stats stats;
+
+    EndgameSolver() = default;
+
+    explicit EndgameSolver(size_t transposition_table_capacity)
+    requires(USES_TRANSPOSITION_TABLE)
+        : transposition_table(transposition_table_capacity)
+    {}
+
+    struct Solution {
+        Board best_move;
+        GameOutcome outcome;
+
+        // plies until the winning move, counting the one being chosen (none for draws)
+        std::optional<size_t> distance_to_mate;
+    };
+
+    [[nodiscard]] GameOutcome prove(const Board& board) {
+        start_solving(board);
+        if (search(board, 0, 0, 1) > 0) {
+            return winner_of(board, true);
+        }
+        if (search(board, 0, -1, 0) < 0) {
+            return winner_of(board, false);
+        }
+        return GameOutcome::DRAW;
+    }
+
+    [[nodiscard]] Solution solve(const Board& board) {
+        start_solving(board);
+        auto moves = board.moves();
+        SolverScore lower_bound = -(horizon - 1);
+        SolverScore upper_bound = horizon;
+        size_t best_move_index = 0;
+        while (lower_bound < upper_bound) {
+            // the first windows are kept close to zero: they settle whether the game is won,
+            // drawn or lost, which is cheap to prove compared to the exact distance to mate
+            SolverScore middle = lower_bound + (upper_bound - lower_bound) / 2;
+            if (middle <= 0 && lower_bound / 2 < middle) {
+                middle = lower_bound / 2;
+            }
+            else if (middle >= 0 && upper_bound / 2 > middle) {
+                middle = upper_bound / 2;
+            }
+            stats.on_null_window_search();
+            SolverScore score = search(board, 0, middle, middle + 1);
+            if (score <= middle) {
+                upper_bound = score;
+            }
+            else {
+                lower_bound = score;
+                best_move_index = root_best_move_index;
+            }
+        }
+        Solution solution { board.make(moves[best_move_index]), GameOutcome::DRAW, std::nullopt };
+        if (lower_bound != 0) {
+            solution.outcome = winner_of(board, lower_bound > 0);
+            solution.distance_to_mate = static_cast<size_t>(horizon + 1 - std::abs(lower_bound));
+        }
+        return solution;
+    }
+
+private:
+
+    // scores are from the point of view of the side to move and count plies from the root: a
+    // game won by the side to move on the e-th ply is worth `horizon + 1 - e` (the sooner the
+    // better), a lost one the opposite and a draw zero, so no score ever needs more than int32
+    SolverScore horizon = 0;
+    size_t root_best_move_index = 0;
+
+    void start_solving(const Board& board) {
+        if (board.outcome().has_value() || board.moves().empty()) {
+            throw std::runtime_error("No moves found");
+        }
+        if (board.remaining_plies() >= size_t(INT16_MAX)) {
+            throw std::runtime_error("Error: the game is too long to be solved");
+        }
+        horizon = static_cast<SolverScore>(board.remaining_plies());
+        root_best_move_index = 0;
+    }
+
+    [[nodiscard]] static GameOutcome winner_of(const Board& board, bool side_to_move_wins) {
+        return (board.current_player_is_maximizing() == side_to_move_wins)
+            ? GameOutcome::MAXIMIZING_PLAYER_WINS
+            : GameOutcome::MINIMIZING_PLAYER_WINS;
+    }
+
+    [[nodiscard]] SolverScore search(const Board& board, size_t ply, SolverScore alpha, SolverScore beta) {
+        stats.on_node(ply);
+        SolverScore current_ply = static_cast<SolverScore>(ply);
+        auto moves = board.moves();
+        GameOutcome win = winner_of(board, true);
+
+        // a move that wins right away can't be improved on, whatever the window
+        for (size_t index = 0; index < moves.size(); index++) {
+            if (board.make(moves[index]).outcome() == win) {
+                if (ply == 0) {
+                    root_best_move_index = index;
+                }
+                stats.on_leaf();
+                return horizon - current_ply;
+            }
+        }
+
+        // otherwise the game can't be won before the side to move plays again, and can't
+        // be lost before the opponent gets to play (close to the end, only a draw is left)
+        SolverScore max_score = std::max(horizon - current_ply - 2, 0);
+        SolverScore min_score = std::min(-(horizon - current_ply - 1), 0);
+        if (beta > max_score) {
+            beta = max_score;
+            if (alpha >= beta) {
+                return beta;
+            }
+        }
+        if (alpha < min_score) {
+            alpha = min_score;
+            if (alpha >= beta) {
+                return alpha;
+            }
+        }
+
+        size_t first_move_index = SIZE_MAX;
+        if (ply != 0 && probe_transposition_table(board, current_ply, alpha, beta, first_move_index)) {
+            return alpha;
+        }
+
+        std::array<size_t, decltype(moves)::CAPACITY> order{};
+        for (size_t index = 0; index < moves.size(); index++) {
+            order[index] = index;
+        }
+        std::stable_sort(order.begin(), order.begin() + moves.size(), [&](size_t lhs, size_t rhs) {
+            if (lhs == first_move_index || rhs == first_move_index) {
+                return lhs == first_move_index && rhs != first_move_index;
+            }
+            if constexpr (USES_BOARD_HINTS) {
+                return board.move_priority(moves[lhs]) > board.move_priority(moves[rhs]);
+            }
+            return false;
+        });
+
+        const SolverScore initial_alpha = alpha;
+        SolverScore best_score = min_score - 1;
+        size_t best_move_index = order[0];
+        for (size_t position = 0; position < moves.size(); position++) {
+            size_t index = order[position];
+            Board child = board.make(moves[index]);
+            SolverScore score = 0;
+            if (child.outcome().has_value()) {
+                stats.on_leaf();
+            }
+            else {
+                score = -search(child, ply + 1, -beta, -alpha);
+            }
+            if (score > best_score) {
+                best_score = score;
+                best_move_index = index;
+            }
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    stats.on_cutoff(position);
+                    break;
+                }
+            }
+        }
+        if (ply == 0) {
+            root_best_move_index = best_move_index;
+        }
+        store_transposition_table(board, current_ply, initial_alpha, beta, best_score, best_move_index);
+        return best_score;
+    }
+
+    // entries must not depend on the root the position was reached from, so they hold the
+    // distance to mate from the position itself: the same offset moves wins up and losses down
+    [[nodiscard]] SolverScore to_entry_score(SolverScore score, SolverScore ply) const {
+        SolverScore offset = INT16_MAX - (horizon - ply);
+        return (score > 0) ? score + offset : (score < 0) ? score - offset : 0;
+    }
+
+    [[nodiscard]] SolverScore from_entry_score(SolverScore score, SolverScore ply) const {
+        SolverScore offset = INT16_MAX - (horizon - ply);
+        return (score > 0) ? score - offset : (score < 0) ? score + offset : 0;
+    }
+
+    // narrows the window using a previously stored result, returns true when the stored
+    // result alone is enough to answer: in that case the score is left in `alpha`
+    [[nodiscard]] bool probe_transposition_table(
+        const Board& board, SolverScore ply, SolverScore& alpha, SolverScore& beta, size_t& first_move_index
+    ) {
+        if constexpr (USES_TRANSPOSITION_TABLE) {
+            auto entry = transposition_table.probe(board.hash());
+            stats.on_transposition_probe(entry.has_value());
+            if (!entry.has_value()) {
+                return false;
+            }
+            first_move_index = entry->best_child().value_or(SIZE_MAX);
+            SolverScore score = from_entry_score(entry->score, ply);
+            switch (entry->bound) {
+                break; case Bound::EXACT: alpha = beta = score; return true;
+                break; case Bound::LOWER: alpha = std::max(alpha, score);
+                break; case Bound::UPPER: beta = std::min(beta, score);
+            }
+            if (alpha >= beta) {
+                alpha = score;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store_transposition_table(
+        const Board& board, SolverScore ply, SolverScore alpha, SolverScore beta,
+        SolverScore score, size_t best_move_index
+    ) {
+        if constexpr (USES_TRANSPOSITION_TABLE) {
+            Bound bound = Bound::EXACT;
+            if (score <= alpha) {
+                bound = Bound::UPPER;
+            }
+            else if (score >= beta) {
+                bound = Bound::LOWER;
+            }
+            transposition_table.store(
+                board.hash(), to_entry_score(score, ply),
+                TranspositionTable<SolverScore>::UNLIMITED_DEPTH, bound, best_move_index
+            );
+        }
+    }
+};
@@ -8,6 +8,9 @@
 #include <cstdint>
 #include <concepts>
 #include <vector>
+#include <memory_resource>
+#include <optional>
+#include <span>
 
 #include "game_score.hpp"
 
@@ -17,3 +20,74 @@ concept game_board = requires (const GB& board) {
     { board.children()                       } -> std::same_as<std::vector<GB>>;
     { board.current_player_is_maximizing()   } -> std::same_as<bool>;
 };
+
+template<typename GB>
+concept hashable_game_board = game_board<GB> && requires (const GB& board) {
+    { board.hash() } -> std::same_as<uint64_t>;
+};
+
+// boards that can list their legal moves without allocating (e.g. through a `MoveList`)
+// and apply them one at a time: the engine then never materializes a vector of children.
+// `make(moves()[i])` is expected to be the same board as `children()[i]`
+template<typename GB>
+concept move_generating_game_board = game_board<GB> && requires (const GB& board, const typename GB::move_t& move) {
+    { board.moves().size()      } -> std::convertible_to<size_t>;
+    { board.moves()[size_t{}]   } -> std::convertible_to<typename GB::move_t>;
+    { board.make(move)          } -> std::same_as<GB>;
+};
+
+// boards that can tell, without playing it, how promising a move looks (higher is better):
+// the engine uses it as the baseline order in which the children of a node are visited
+template<typename GB>
+concept move_ordering_game_board = move_generating_game_board<GB> && requires (const GB& board, const typename GB::move_t& move) {
+    { board.move_priority(move) } -> std::convertible_to<int64_t>;
+};
+
+// boards that can build their children into memory handed out by the engine, which then
+// recycles it from one node to the next instead of going through the allocator every time
+template<typename GB>
+concept allocator_aware_game_board = game_board<GB> && requires (const GB& board, std::pmr::memory_resource* resource) {
+    { board.children(resource) } -> std::same_as<std::pmr::vector<GB>>;
+};
+
+// boards that know the exact value of some of their positions (e.g. from a solved table):
+// the engine takes it as the final score of the node, without searching any further
+template<typename GB>
+concept solved_game_board = game_board<GB> && requires (const GB& board) {
+    { board.solved_score() } -> std::same_as<std::optional<decltype(board.evaluate())>>;
+};
+
+// boards that score all of their children at once (in the order of `moves()`), e.g. through
+// SIMD instructions: nodes right above the horizon then get their leaves evaluated in a single
+// call. The returned mask has the i-th bit set when the game goes on after the i-th move, and
+// every score must be exactly what the child's own `evaluate()` would return
+template<typename GB>
+concept batch_evaluating_game_board = move_generating_game_board<GB>
+    && requires (const GB& board, std::span<decltype(board.evaluate())> scores) {
+    { board.evaluate_children(scores) } -> std::same_as<uint64_t>;
+};
+
+// boards that can tell when a position is too volatile to be evaluated, by listing its forcing
+// moves (e.g. immediate wins, or the blocks every other move would lose to): past the horizon,
+// the engine keeps searching those moves only, and evaluates the position once it has none.
+// The best move of a position must be among its forcing moves whenever there are any
+template<typename GB>
+concept quiescent_game_board = move_generating_game_board<GB> && requires (const GB& board) {
+    { board.forcing_moves().size()      } -> std::convertible_to<size_t>;
+    { board.forcing_moves()[size_t{}]   } -> std::convertible_to<typename GB::move_t>;
+};
+
+enum class GameOutcome : uint8_t {
+    MAXIMIZING_PLAYER_WINS,
+    MINIMIZING_PLAYER_WINS,
+    DRAW
+};
+
+// boards that can tell whether the game is over (and how it ended) and bound how many more
+// plies it can last: their positions can be proven won, drawn or lost (see `endgame_solver.hpp`)
+// rather than estimated through `evaluate()`
+template<typename GB>
+concept solvable_game_board = move_generating_game_board<GB> && requires (const GB& board) {
+    { board.outcome()         } -> std::same_as<std::optional<GameOutcome>>;
+    { board.remaining_plies() } -> std::convertible_to<size_t>;
+};
@@ -8,15 +8,136 @@
 #include <cstdint>
 #include <concepts>
 #include <vector>
+#include <limits>
+#include <type_traits>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <algorithm>
+
+// Range and special values of a score type, which the engine relies on instead of reading
+// `std::numeric_limits` directly: its `min()` is the smallest positive value for floating point
+// types, and the most negative integer has no opposite. Every score lies within `[lowest(),
+// highest()]`, a range closed under `negate` (mirrored around the middle for unsigned types,
+// whose scores are all non-negative). Floating point scores are unbounded, so that whatever
+// a learned evaluator returns (infinities included) can't fall outside of the full window.
+template<typename Score>
+struct score_traits {
+
+    static_assert(std::is_arithmetic_v<Score> && !std::is_same_v<Score, bool>);
+
+    [[nodiscard]] static constexpr Score highest() {
+        if constexpr (std::numeric_limits<Score>::has_infinity) {
+            return std::numeric_limits<Score>::infinity();
+        }
+        else {
+            return std::numeric_limits<Score>::max();
+        }
+    }
+
+    [[nodiscard]] static constexpr Score lowest() {
+        if constexpr (std::is_unsigned_v<Score>) {
+            return Score{0};
+        }
+        else {
+            return static_cast<Score>(-highest());
+        }
+    }
+
+    // equality built from `<` alone, the only comparison the engine makes between scores:
+    // floating point ones must never be compared through `==` (see `-Wfloat-equal`)
+    [[nodiscard]] static constexpr bool equal(Score lhs, Score rhs) {
+        return !(lhs < rhs) && !(rhs < lhs);
+    }
+
+    // the opponent's point of view on the same score
+    [[nodiscard]] static constexpr Score negate(Score score) {
+        if constexpr (std::is_unsigned_v<Score>) {
+            return static_cast<Score>(highest() - score);
+        }
+        else if constexpr (std::is_integral_v<Score>) {
+            return (score < lowest()) ? highest() : static_cast<Score>(-score);
+        }
+        else {
+            return -score;
+        }
+    }
+
+    // Games won or lost are scored beyond any heuristic evaluation, and the sooner the better
+    // for the winner: a win reached on the given ply is worth `MATE - plies`, a loss the negation
+    // of it (plies may count from the start of the game or from the root, as long as the board
+    // is consistent). For floating point types `MATE` is a power of two small enough for plies
+    // to be still counted exactly, leaving heuristic evaluations plenty of room below it.
+    static constexpr Score MATE = std::is_floating_point_v<Score>
+        ? static_cast<Score>(Score{1} / std::numeric_limits<Score>::epsilon())
+        : std::numeric_limits<Score>::max();
+
+    // scores within this many plies of `MATE` are taken as decided games
+    static constexpr size_t MAX_MATE_PLIES = std::min<size_t>(
+        4096, std::is_unsigned_v<Score> ? size_t(MATE / 4) : size_t(MATE / 2)
+    );
+
+    [[nodiscard]] static constexpr Score win_in(size_t plies) {
+        return static_cast<Score>(MATE - static_cast<Score>(std::min(plies, MAX_MATE_PLIES)));
+    }
+
+    [[nodiscard]] static constexpr Score loss_in(size_t plies) {
+        return negate(win_in(plies));
+    }
+
+    // plies until the game is decided, when the score says it is (see `win_in`); which side
+    // wins is told by the sign (by the half of the range, for unsigned types)
+    [[nodiscard]] static constexpr std::optional<size_t> mate_distance(Score score) {
+        Score winning = std::max(score, negate(score));
+        if (winning < win_in(MAX_MATE_PLIES) || winning > MATE) {
+            return std::nullopt;
+        }
+        return static_cast<size_t>(MATE - winning);
+    }
+};
 
 template<typename Score>
 [[nodiscard]] Score sup_limit() {
-    return std::numeric_limits<Score>::max();
+    return score_traits<Score>::highest();
 }
 
 template<typename Score>
 [[nodiscard]] Score inf_limit() {
-    return std::numeric_limits<Score>::min();
+    return score_traits<Score>::lowest();
+}
+
+// smallest score strictly greater than the given one (if any), used to build null windows
+template<typename Score>
+[[nodiscard]] Score next_score(Score score) {
+    if constexpr (std::is_floating_point_v<Score>) {
+        return std::nextafter(score, std::numeric_limits<Score>::infinity());
+    }
+    else {
+        return (score >= sup_limit<Score>()) ? score : static_cast<Score>(score + 1);
+    }
+}
+
+// greatest score strictly smaller than the given one (if any), used to build null windows
+template<typename Score>
+[[nodiscard]] Score prev_score(Score score) {
+    if constexpr (std::is_floating_point_v<Score>) {
+        return std::nextafter(score, -std::numeric_limits<Score>::infinity());
+    }
+    else {
+        return (score <= inf_limit<Score>()) ? score : static_cast<Score>(score - 1);
+    }
+}
+
+// `score - amount`, or the lowest score when that would fall below it (`amount` is non-negative)
+template<typename Score>
+[[nodiscard]] Score lower_score_by(Score score, Score amount) {
+    return (score < static_cast<Score>(inf_limit<Score>() + amount)) ? inf_limit<Score>() : static_cast<Score>(score - amount);
+}
+
+// `score + amount`, or the highest score when that would rise above it (`amount` is non-negative)
+template<typename Score>
+[[nodiscard]] Score raise_score_by(Score score, Score amount) {
+    return (score > static_cast<Score>(sup_limit<Score>() - amount)) ? sup_limit<Score>() : static_cast<Score>(score + amount);
 }
 
 template<typename GS>
@@ -36,4 +157,10 @@ static_assert(game_score<uint16_t>);
 static_assert(game_score<uint32_t>);
 static_assert(game_score<uint64_t>);
 static_assert(game_score<float>);
-static_assert(game_score<double>);
\ No newline at end of file
+static_assert(game_score<double>);
+
+static_assert(score_traits<int32_t>::negate(score_traits<int32_t>::lowest()) == score_traits<int32_t>::highest());
+static_assert(score_traits<uint8_t>::negate(score_traits<uint8_t>::win_in(3)) == score_traits<uint8_t>::loss_in(3));
+static_assert(score_traits<float>::lowest() < score_traits<float>::loss_in(0));
+static_assert(score_traits<double>::win_in(1) < score_traits<double>::win_in(0));
+static_assert(score_traits<float>::equal(score_traits<float>::win_in(2), score_traits<float>::MATE - 2));
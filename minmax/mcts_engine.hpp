@@ -0,0 +1,529 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <concepts>
+#include <utility>
+
+#include "game_board.hpp"
+#include "game_score.hpp"
+#include "work_stealing_pool.hpp"
+
+enum class SelectionPolicy {
+    UCT,
+    PUCT
+};
+
+// Monte Carlo tree search over the same boards as `SearchEngine`: positions are judged by the
+// outcome of random games played from them rather than by a heuristic, so `evaluate()` only
+// needs to tell who won once the game is over. The tree grows one node per iteration, the
+// most visited child of the root being the move played. Nodes live in a fixed-capacity arena
+// (the tree simply stops growing once it's full), and the subtree of the position reached
+// by the next search is kept, as long as positions can be recognized (hashed or compared).
+template <game_board Board>
+class MctsEngine {
+
+public:
+
+    using Score = decltype(std::declval<const Board&>().evaluate());
+
+    static constexpr bool USES_MOVE_GENERATION = move_generating_game_board<Board>;
+    static constexpr bool USES_BOARD_HINTS = move_ordering_game_board<Board>;
+    static constexpr bool USES_TREE_REUSE = hashable_game_board<Board> || std::equality_comparable<Board>;
+
+    static constexpr size_t DEFAULT_NODE_CAPACITY = size_t(1) << 18;
+
+    SelectionPolicy selection_policy = SelectionPolicy::UCT;
+
+    // weight of exploration against exploitation, for UCT the usual sqrt(2)
+    double exploration = 1.41;
+
+    // with PUCT, children are explored in proportion to priors given by a softmax of the
+    // board hints at this temperature (uniform priors for boards without hints)
+    double prior_temperature = 1.0;
+
+    // playouts that don't end within this many plies are scored by whichever side
+    // `evaluate()` favours at that point
+    size_t max_playout_plies = SIZE_MAX;
+
+    // chance that a playout picks the move with the highest board hint instead of a random one
+    double playout_hint_probability = 0.0;
+
+    // workers share the tree: each node on the path of an unfinished iteration counts as this
+    // many lost visits, so that the others spread over different lines meanwhile
+    size_t thread_count = 1;
+    uint32_t virtual_loss = 3;
+
+    bool reuse_tree = true;
+    uint64_t seed = 0x9e3779b97f4a7c15ULL;
+
+    explicit MctsEngine(size_t node_capacity = DEFAULT_NODE_CAPACITY)
+        : node_capacity(std::clamp<size_t>(node_capacity, 2, UINT32_MAX))
+    {}
+
+    MctsEngine(const MctsEngine&) = delete;
+    MctsEngine& operator=(const MctsEngine&) = delete;
+
+    struct AnalysisResult {
+        Board best_move;
+
+        // average outcome of the playouts through the best move for the side to move:
+        // 1 when they're all won, 0 when they're all lost, draws count as one half
+        double expected_outcome = 0;
+        size_t best_move_visits = 0;
+        size_t iterations = 0;
+
+        // visits the root had already been given by the searches before this one
+        size_t reused_visits = 0;
+    };
+
+    [[nodiscard]] Board find_best_move(size_t iterations, const Board& board) {
+        return analyze(iterations, board).best_move;
+    }
+
+    [[nodiscard]] AnalysisResult analyze(size_t iterations, const Board& board) {
+        return search(board, iterations, std::nullopt);
+    }
+
+    template <typename Rep, typename Period>
+    [[nodiscard]] AnalysisResult analyze_within(std::chrono::duration<Rep, Period> time_budget, const Board& board) {
+        return search(board, SIZE_MAX, std::chrono::steady_clock::now() + time_budget);
+    }
+
+    template <typename Rep, typename Period>
+    [[nodiscard]] Board find_best_move_within(std::chrono::duration<Rep, Period> time_budget, const Board& board) {
+        return analyze_within(time_budget, board).best_move;
+    }
+
+    // drops the tree, so that the next search starts from scratch
+    void clear() {
+        node_count = 0;
+    }
+
+    [[nodiscard]] size_t tree_size() const {
+        return std::min<size_t>(node_count.load(), node_capacity);
+    }
+
+private:
+
+    enum class Expansion : uint8_t {
+        UNEXPANDED,
+        EXPANDING,
+        EXPANDED,
+        TERMINAL
+    };
+
+    // rewards are counted in half points (win 2, draw 1, loss 0) from the point of view of the
+    // player who made the move leading to the node, which is the one choosing it at the parent
+    struct Node {
+        std::optional<Board> board;
+        std::atomic<uint32_t> visits = 0;
+        std::atomic<uint64_t> reward = 0;
+        std::atomic<Expansion> expansion = Expansion::UNEXPANDED;
+        uint32_t first_child = 0;
+        uint32_t children_count = 0;
+        float prior = 1;
+        uint8_t terminal_reward = 0;
+    };
+
+    static constexpr uint32_t ROOT = 0;
+    static constexpr size_t CLOCK_CHECK_INTERVAL = 64;
+
+    // splitmix64: playouts only need cheap, decently spread numbers, one stream per worker
+    struct PlayoutRandom {
+        uint64_t state;
+
+        [[nodiscard]] uint64_t next() {
+            uint64_t value = (state += 0x9e3779b97f4a7c15ULL);
+            value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+            return value ^ (value >> 31);
+        }
+
+        [[nodiscard]] size_t below(size_t bound) {
+            return static_cast<size_t>(next() % bound);
+        }
+
+        [[nodiscard]] double unit() {
+            return static_cast<double>(next() >> 11) * 0x1.0p-53;
+        }
+    };
+
+    size_t node_capacity;
+    std::unique_ptr<Node[]> nodes;
+    std::unique_ptr<Node[]> spare_nodes;
+    std::atomic<size_t> node_count = 0;
+
+    std::unique_ptr<WorkStealingPool> pool;
+    std::vector<PlayoutRandom> random_streams;
+
+    [[nodiscard]] static bool same_position(const Board& lhs, const Board& rhs) {
+        if constexpr (hashable_game_board<Board>) {
+            return lhs.hash() == rhs.hash();
+        }
+        else if constexpr (std::equality_comparable<Board>) {
+            return lhs == rhs;
+        }
+        else {
+            return false;
+        }
+    }
+
+    // half points scored by the maximizing player in a finished game (or the one `evaluate()`
+    // favours, for playouts cut short): a score beats its opponent's view of it when it's won
+    [[nodiscard]] static uint8_t maximizing_reward(const Board& board) {
+        Score score = board.evaluate();
+        Score opposite = score_traits<Score>::negate(score);
+        return (score > opposite) ? 2 : (score < opposite) ? 0 : 1;
+    }
+
+    [[nodiscard]] static uint8_t reward_for(bool maximizing, uint8_t reward_of_maximizing) {
+        return (maximizing) ? reward_of_maximizing : static_cast<uint8_t>(2 - reward_of_maximizing);
+    }
+
+    [[nodiscard]] std::optional<uint32_t> allocate_nodes(size_t count) {
+        size_t first = node_count.fetch_add(count);
+        if (first + count > node_capacity) {
+            return std::nullopt;
+        }
+        return static_cast<uint32_t>(first);
+    }
+
+    static void reset_node(Node& node, const Board& board) {
+        node.board.emplace(board);
+        node.visits.store(0, std::memory_order_relaxed);
+        node.reward.store(0, std::memory_order_relaxed);
+        node.expansion.store(Expansion::UNEXPANDED, std::memory_order_relaxed);
+        node.first_child = 0;
+        node.children_count = 0;
+        node.prior = 1;
+        node.terminal_reward = 0;
+    }
+
+    void prepare_root(const Board& board, size_t& reused_visits) {
+        if (!nodes) {
+            nodes = std::make_unique<Node[]>(node_capacity);
+        }
+        node_count = std::min<size_t>(node_count.load(), node_capacity);
+        if (reuse_tree && node_count > 0) {
+            if (auto subtree = find_subtree(board); subtree.has_value()) {
+                if (*subtree != ROOT) {
+                    keep_only_subtree(*subtree);
+                }
+                reused_visits = nodes[ROOT].visits.load();
+                return;
+            }
+        }
+        node_count = 1;
+        reset_node(nodes[ROOT], board);
+    }
+
+    // the position is looked for among the root and its descendants up to the replies to
+    // the replies, which covers the search for the next move of either player
+    [[nodiscard]] std::optional<uint32_t> find_subtree(const Board& board) const {
+        if constexpr (USES_TREE_REUSE) {
+            std::vector<uint32_t> level { ROOT };
+            for (size_t depth = 0; depth <= 2 && !level.empty(); depth++) {
+                std::vector<uint32_t> next_level;
+                for (uint32_t index : level) {
+                    const Node& node = nodes[index];
+                    if (same_position(*node.board, board)) {
+                        return index;
+                    }
+                    if (node.expansion.load() == Expansion::EXPANDED) {
+                        for (uint32_t child = 0; child < node.children_count; child++) {
+                            next_level.push_back(node.first_child + child);
+                        }
+                    }
+                }
+                level = std::move(next_level);
+            }
+        }
+        return std::nullopt;
+    }
+
+    // copies the subtree breadth first into the spare arena, which becomes the current one:
+    // siblings are copied together, so they stay contiguous as every node expects
+    void keep_only_subtree(uint32_t subtree) {
+        if (!spare_nodes) {
+            spare_nodes = std::make_unique<Node[]>(node_capacity);
+        }
+        auto copy = [](const Node& source, Node& target) {
+            target.board = source.board;
+            target.visits.store(source.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            target.reward.store(source.reward.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            target.expansion.store(source.expansion.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            target.first_child = 0;
+            target.children_count = source.children_count;
+            target.prior = source.prior;
+            target.terminal_reward = source.terminal_reward;
+        };
+        copy(nodes[subtree], spare_nodes[ROOT]);
+        std::vector<std::pair<uint32_t, uint32_t>> pending { { subtree, ROOT } };
+        uint32_t copied = 1;
+        for (size_t position = 0; position < pending.size(); position++) {
+            auto [source_index, target_index] = pending[position];
+            const Node& source = nodes[source_index];
+            Node& target = spare_nodes[target_index];
+            if (source.expansion.load(std::memory_order_relaxed) != Expansion::EXPANDED) {
+                continue;
+            }
+            target.first_child = copied;
+            for (uint32_t child = 0; child < source.children_count; child++) {
+                copy(nodes[source.first_child + child], spare_nodes[copied + child]);
+                pending.emplace_back(source.first_child + child, copied + child);
+            }
+            copied += source.children_count;
+        }
+        std::swap(nodes, spare_nodes);
+        node_count = copied;
+    }
+
+    // children are allocated all at once, so that they can be found from their first one;
+    // a full arena leaves the node unexpanded, its visits then all end in a playout
+    [[nodiscard]] bool expand(Node& node) {
+        Expansion expected = Expansion::UNEXPANDED;
+        if (!node.expansion.compare_exchange_strong(expected, Expansion::EXPANDING, std::memory_order_acquire)) {
+            return expected == Expansion::EXPANDED;
+        }
+        const Board& board = *node.board;
+        std::vector<Board> children;
+        std::vector<double> hints;
+        if constexpr (USES_MOVE_GENERATION) {
+            auto moves = board.moves();
+            for (size_t index = 0; index < moves.size(); index++) {
+                children.push_back(board.make(moves[index]));
+                if constexpr (USES_BOARD_HINTS) {
+                    hints.push_back(static_cast<double>(board.move_priority(moves[index])));
+                }
+            }
+        }
+        else {
+            children = board.children();
+        }
+        if (children.empty()) {
+            node.terminal_reward = maximizing_reward(board);
+            node.expansion.store(Expansion::TERMINAL, std::memory_order_release);
+            return false;
+        }
+        auto first = allocate_nodes(children.size());
+        if (!first.has_value()) {
+            node.expansion.store(Expansion::UNEXPANDED, std::memory_order_release);
+            return false;
+        }
+        std::vector<double> priors = priors_of(hints, children.size());
+        for (size_t index = 0; index < children.size(); index++) {
+            Node& child = nodes[*first + index];
+            reset_node(child, children[index]);
+            child.prior = static_cast<float>(priors[index]);
+        }
+        node.first_child = *first;
+        node.children_count = static_cast<uint32_t>(children.size());
+        node.expansion.store(Expansion::EXPANDED, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] std::vector<double> priors_of(const std::vector<double>& hints, size_t children_count) const {
+        std::vector<double> priors(children_count, 1.0 / static_cast<double>(children_count));
+        if (hints.size() != children_count || selection_policy != SelectionPolicy::PUCT) {
+            return priors;
+        }
+        double highest_hint = *std::max_element(hints.begin(), hints.end());
+        double total = 0;
+        for (size_t index = 0; index < children_count; index++) {
+            priors[index] = std::exp((hints[index] - highest_hint) / prior_temperature);
+            total += priors[index];
+        }
+        for (double& prior : priors) {
+            prior /= total;
+        }
+        return priors;
+    }
+
+    [[nodiscard]] uint32_t select_child(const Node& node) const {
+        double parent_visits = std::max<double>(node.visits.load(std::memory_order_relaxed), 1);
+        double log_parent_visits = std::log(parent_visits);
+        double sqrt_parent_visits = std::sqrt(parent_visits);
+        uint32_t best_child = node.first_child;
+        double best_priority = -std::numeric_limits<double>::infinity();
+        for (uint32_t index = node.first_child; index < node.first_child + node.children_count; index++) {
+            const Node& child = nodes[index];
+            uint32_t visit_count = child.visits.load(std::memory_order_relaxed);
+            double visits = visit_count;
+            double mean = (visit_count > 0) ? child.reward.load(std::memory_order_relaxed) / (2 * visits) : 0.5;
+            double priority = 0;
+            if (selection_policy == SelectionPolicy::UCT) {
+                if (visit_count == 0) {
+                    return index;
+                }
+                priority = mean + exploration * std::sqrt(log_parent_visits / visits);
+            }
+            else {
+                priority = mean + exploration * child.prior * sqrt_parent_visits / (1 + visits);
+            }
+            if (priority > best_priority) {
+                best_priority = priority;
+                best_child = index;
+            }
+        }
+        return best_child;
+    }
+
+    [[nodiscard]] uint8_t playout(Board board, PlayoutRandom& random) const {
+        for (size_t plies = 0; plies < max_playout_plies; plies++) {
+            if constexpr (USES_MOVE_GENERATION) {
+                auto moves = board.moves();
+                if (moves.size() == 0) {
+                    return maximizing_reward(board);
+                }
+                size_t index = random.below(moves.size());
+                if constexpr (USES_BOARD_HINTS) {
+                    if (playout_hint_probability > 0 && random.unit() < playout_hint_probability) {
+                        for (size_t candidate = 0; candidate < moves.size(); candidate++) {
+                            if (board.move_priority(moves[candidate]) > board.move_priority(moves[index])) {
+                                index = candidate;
+                            }
+                        }
+                    }
+                }
+                board = board.make(moves[index]);
+            }
+            else {
+                auto children = board.children();
+                if (children.empty()) {
+                    return maximizing_reward(board);
+                }
+                board = std::move(children[random.below(children.size())]);
+            }
+        }
+        return maximizing_reward(board);
+    }
+
+    // one selection, expansion, playout and backpropagation: nodes on the path keep their
+    // virtual loss until the outcome is known
+    void run_iteration(std::vector<uint32_t>& path, PlayoutRandom& random) {
+        path.clear();
+        path.push_back(ROOT);
+        nodes[ROOT].visits.fetch_add(virtual_loss, std::memory_order_relaxed);
+        uint8_t reward_of_maximizing = 0;
+        while (true) {
+            Node& node = nodes[path.back()];
+            Expansion expansion = node.expansion.load(std::memory_order_acquire);
+            if (expansion == Expansion::TERMINAL) {
+                reward_of_maximizing = node.terminal_reward;
+                break;
+            }
+            // leaves get expanded on their second visit, the first one only gets a playout
+            bool expandable = expansion == Expansion::UNEXPANDED
+                && (path.size() == 1 || node.visits.load(std::memory_order_relaxed) > virtual_loss);
+            if (expansion == Expansion::EXPANDED || (expandable && expand(node))) {
+                uint32_t child = select_child(node);
+                nodes[child].visits.fetch_add(virtual_loss, std::memory_order_relaxed);
+                path.push_back(child);
+                continue;
+            }
+            if (node.expansion.load(std::memory_order_acquire) == Expansion::TERMINAL) {
+                reward_of_maximizing = node.terminal_reward;
+                break;
+            }
+            reward_of_maximizing = playout(*node.board, random);
+            break;
+        }
+        for (size_t position = 0; position < path.size(); position++) {
+            Node& node = nodes[path[position]];
+            if (position != 0) {
+                bool chooser_maximizing = nodes[path[position - 1]].board->current_player_is_maximizing();
+                node.reward.fetch_add(reward_for(chooser_maximizing, reward_of_maximizing), std::memory_order_relaxed);
+            }
+            node.visits.fetch_sub(virtual_loss - 1, std::memory_order_relaxed);
+        }
+    }
+
+    void run_worker(
+        size_t worker, std::atomic<size_t>& started_iterations, size_t iterations,
+        std::optional<std::chrono::steady_clock::time_point> deadline
+    ) {
+        PlayoutRandom& random = random_streams[worker];
+        std::vector<uint32_t> path;
+        for (size_t iteration = 0;; iteration++) {
+            if (started_iterations.fetch_add(1, std::memory_order_relaxed) >= iterations) {
+                return;
+            }
+            // the first iteration expands the root, so a move is available however short the budget
+            bool root_expanded = nodes[ROOT].expansion.load(std::memory_order_acquire) == Expansion::EXPANDED;
+            if (deadline.has_value() && iteration % CLOCK_CHECK_INTERVAL == 0 && root_expanded
+                && std::chrono::steady_clock::now() >= *deadline) {
+                return;
+            }
+            run_iteration(path, random);
+        }
+    }
+
+    [[nodiscard]] AnalysisResult search(
+        const Board& board, size_t iterations, std::optional<std::chrono::steady_clock::time_point> deadline
+    ) {
+        if (board.children().empty()) {
+            throw std::runtime_error("No moves found");
+        }
+        size_t reused_visits = 0;
+        prepare_root(board, reused_visits);
+        size_t workers = std::max<size_t>(thread_count, 1);
+        while (random_streams.size() < workers) {
+            random_streams.push_back(PlayoutRandom { seed + random_streams.size() * 0x632be59bd9b4e019ULL });
+        }
+        std::atomic<size_t> started_iterations = 0;
+        size_t visits_before = nodes[ROOT].visits.load();
+        if (workers == 1) {
+            run_worker(0, started_iterations, std::max<size_t>(iterations, 1), deadline);
+        }
+        else {
+            if (!pool || pool->size() != workers) {
+                pool.reset();
+                pool = std::make_unique<WorkStealingPool>(workers);
+            }
+            TaskGroup group;
+            for (size_t worker = 0; worker < workers; worker++) {
+                group.run(*pool, [&, worker] {
+                    run_worker(worker, started_iterations, std::max<size_t>(iterations, 1), deadline);
+                });
+            }
+            group.wait(*pool);
+        }
+        return result_of(nodes[ROOT].visits.load() - visits_before, reused_visits);
+    }
+
+    [[nodiscard]] AnalysisResult result_of(size_t iterations, size_t reused_visits) const {
+        const Node& root = nodes[ROOT];
+        if (root.expansion.load() != Expansion::EXPANDED) {
+            throw std::runtime_error("Error: the tree has no room for the root's children");
+        }
+        uint32_t best_child = root.first_child;
+        for (uint32_t index = root.first_child; index < root.first_child + root.children_count; index++) {
+            if (nodes[index].visits.load() > nodes[best_child].visits.load()) {
+                best_child = index;
+            }
+        }
+        const Node& best = nodes[best_child];
+        size_t visits = best.visits.load();
+        AnalysisResult result { .best_move = *best.board };
+        result.expected_outcome = (visits > 0) ? static_cast<double>(best.reward.load()) / (2.0 * visits) : 0.5;
+        result.best_move_visits = visits;
+        result.iterations = iterations;
+        result.reused_visits = reused_visits;
+        return result;
+    }
+};
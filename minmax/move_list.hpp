@@ -0,0 +1,58 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+#include <array>
+
+// fixed-capacity, stack-allocated list of moves: boards that know an upper bound
+// on the number of legal moves can hand it to the engine without touching the heap
+template <typename Move, size_t Capacity>
+class MoveList {
+
+    std::array<Move, Capacity> moves{};
+    size_t count = 0;
+
+public:
+
+    static constexpr size_t CAPACITY = Capacity;
+
+    void push_back(const Move& move) {
+        moves[count++] = move;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return count;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return count == 0;
+    }
+
+    [[nodiscard]] const Move& operator[](size_t index) const {
+        return moves[index];
+    }
+
+    [[nodiscard]] Move& operator[](size_t index) {
+        return moves[index];
+    }
+
+    [[nodiscard]] const Move* begin() const {
+        return moves.data();
+    }
+
+    [[nodiscard]] const Move* end() const {
+        return moves.data() + count;
+    }
+
+    [[nodiscard]] Move* begin() {
+        return moves.data();
+    }
+
+    [[nodiscard]] Move* end() {
+        return moves.data() + count;
+    }
+};
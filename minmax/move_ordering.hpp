@@ -0,0 +1,78 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <optional>
+#include <functional>
+
+// every heuristic can be turned off on its own, so that its effect on the
+// number of visited nodes can be measured separately from the others
+struct MoveOrderingOptions {
+    bool board_hints = true;
+    bool killer_moves = true;
+    bool history_heuristic = true;
+};
+
+// Killer moves (the last two moves that caused a cutoff at a given distance from the root)
+// and history scores (how much cutoff-causing each move has been so far, per side): killers
+// are indexed by ply rather than by remaining depth, which shifts from one iteration to the
+// next of iterative deepening while the positions at a given ply stay alike
+template <typename Move>
+class MoveOrderingTables {
+
+    static constexpr size_t MAX_KILLER_PLY = 64;
+    static constexpr size_t HISTORY_SIZE = 1024;
+
+    std::array<std::array<std::optional<Move>, 2>, MAX_KILLER_PLY> killers{};
+    std::array<std::array<uint64_t, HISTORY_SIZE>, 2> history{};
+
+    [[nodiscard]] static size_t history_index(const Move& move) {
+        return std::hash<Move>{}(move) % HISTORY_SIZE;
+    }
+
+public:
+
+    void clear() {
+        killers = {};
+        history = {};
+    }
+
+    // 2 for the most recent killer move, 1 for the other one, 0 for non-killer moves
+    [[nodiscard]] int killer_rank(size_t ply, const Move& move) const {
+        if (ply >= MAX_KILLER_PLY) {
+            return 0;
+        }
+        if (killers[ply][0] == move) {
+            return 2;
+        }
+        if (killers[ply][1] == move) {
+            return 1;
+        }
+        return 0;
+    }
+
+    [[nodiscard]] uint64_t history_score(bool maximizing, const Move& move) const {
+        return history[maximizing][history_index(move)];
+    }
+
+    // deeper subtrees weigh more in the history, their cutoffs saved more nodes
+    void record_cutoff(size_t ply, size_t depth, bool maximizing, const Move& move, const MoveOrderingOptions& options) {
+        if (options.killer_moves && ply < MAX_KILLER_PLY && killers[ply][0] != move) {
+            killers[ply][1] = killers[ply][0];
+            killers[ply][0] = move;
+        }
+        if (options.history_heuristic) {
+            history[maximizing][history_index(move)] += depth * depth;
+        }
+    }
+};
+
+struct NoMoveOrderingTables {
+    void clear() {}
+};
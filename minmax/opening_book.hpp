@@ -0,0 +1,230 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <span>
+#include <optional>
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MINMAX_OPENING_BOOK_MMAP 1
+#endif
+
+#include "game_score.hpp"
+
+// Results of deep searches run offline (see `tools/opening_book_builder.cpp`), keyed by the
+// hash of the searched position. The best move is stored as its index among the position's
+// children, so it's only meaningful to the board type (and hash function) that built the book.
+template <game_score Score>
+struct OpeningBookEntry {
+    uint64_t key = 0;
+    Score score{};
+    uint16_t depth = 0;
+    uint8_t best_child_index = 0;
+};
+
+// entries are padded up to the alignment of the score, the padding being written as zeros
+static_assert(sizeof(OpeningBookEntry<int>) == 16 && sizeof(OpeningBookEntry<double>) == 24);
+
+// File layout: a fixed header followed by the entries sorted by key, both stored exactly as
+// they are laid out in memory (hence in native byte order, which the magic number detects):
+// the file gets mapped as it is and searched in place, nothing is parsed or copied at startup
+struct OpeningBookHeader {
+    static constexpr uint64_t MAGIC = 0x4b4f4f42584d4e4dULL; // "MNMXBOOK" in little endian
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t entry_size = 0;
+    uint32_t score_size = 0;
+    uint32_t score_is_floating_point = 0;
+    uint64_t entry_count = 0;
+};
+
+// no padding, so the header can be written as it is laid out in memory
+static_assert(sizeof(OpeningBookHeader) == 32 && std::has_unique_object_representations_v<OpeningBookHeader>);
+
+template <game_score Score>
+[[nodiscard]] OpeningBookHeader opening_book_header_for(size_t entry_count) {
+    OpeningBookHeader header;
+    header.entry_size = sizeof(OpeningBookEntry<Score>);
+    header.score_size = sizeof(Score);
+    header.score_is_floating_point = std::is_floating_point_v<Score>;
+    header.entry_count = entry_count;
+    return header;
+}
+
+// every field at its offset in an entry whose padding is zeroed: the padding of `entry`
+// itself is indeterminate, and would make the same book come out different every time
+template <game_score Score>
+[[nodiscard]] std::array<char, sizeof(OpeningBookEntry<Score>)> opening_book_record_of(const OpeningBookEntry<Score>& entry) {
+    using Entry = OpeningBookEntry<Score>;
+    std::array<char, sizeof(Entry)> record{};
+    std::memcpy(record.data() + offsetof(Entry, key), &entry.key, sizeof(entry.key));
+    std::memcpy(record.data() + offsetof(Entry, score), &entry.score, sizeof(entry.score));
+    std::memcpy(record.data() + offsetof(Entry, depth), &entry.depth, sizeof(entry.depth));
+    std::memcpy(record.data() + offsetof(Entry, best_child_index), &entry.best_child_index, sizeof(entry.best_child_index));
+    return record;
+}
+
+// entries get sorted here, a key that shows up more than once keeps its deepest result
+template <game_score Score>
+void write_opening_book(const std::string& path, std::vector<OpeningBookEntry<Score>> entries) {
+    static_assert(std::is_trivially_copyable_v<OpeningBookEntry<Score>> && std::is_standard_layout_v<OpeningBookEntry<Score>>);
+    std::stable_sort(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+        return (lhs.key != rhs.key) ? lhs.key < rhs.key : lhs.depth > rhs.depth;
+    });
+    auto duplicates = std::unique(entries.begin(), entries.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.key == rhs.key;
+    });
+    entries.erase(duplicates, entries.end());
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Error: cannot write opening book " + path);
+    }
+    OpeningBookHeader header = opening_book_header_for<Score>(entries.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& entry : entries) {
+        auto record = opening_book_record_of(entry);
+        file.write(record.data(), record.size());
+    }
+    if (!file) {
+        throw std::runtime_error("Error: cannot write opening book " + path);
+    }
+}
+
+// Read-only view over a book file: on POSIX systems the file is memory mapped, so opening a
+// book costs a system call regardless of its size and its pages are shared by every process
+// using it; elsewhere it falls back to reading the whole file at once
+template <game_score Score>
+class OpeningBook {
+
+    using Entry = OpeningBookEntry<Score>;
+
+    static_assert(std::is_trivially_copyable_v<Entry> && sizeof(OpeningBookHeader) % alignof(Entry) == 0);
+
+    const std::byte* mapping = nullptr;
+    size_t mapping_size = 0;
+    std::vector<std::byte> fallback_buffer;
+    std::span<const Entry> entries;
+
+    void release() {
+#ifdef MINMAX_OPENING_BOOK_MMAP
+        if (mapping != nullptr && fallback_buffer.empty()) {
+            munmap(const_cast<std::byte*>(mapping), mapping_size);
+        }
+#endif
+        mapping = nullptr;
+        mapping_size = 0;
+        fallback_buffer.clear();
+        entries = {};
+    }
+
+    void map_file(const std::string& path) {
+#ifdef MINMAX_OPENING_BOOK_MMAP
+        int descriptor = ::open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error("Error: cannot open opening book " + path);
+        }
+        struct stat file_status {};
+        if (fstat(descriptor, &file_status) != 0 || file_status.st_size < static_cast<off_t>(sizeof(OpeningBookHeader))) {
+            ::close(descriptor);
+            throw std::runtime_error("Error: malformed opening book " + path);
+        }
+        void* address = mmap(nullptr, file_status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        ::close(descriptor);
+        if (address == MAP_FAILED) {
+            throw std::runtime_error("Error: cannot map opening book " + path);
+        }
+        mapping = static_cast<const std::byte*>(address);
+        mapping_size = file_status.st_size;
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            throw std::runtime_error("Error: cannot open opening book " + path);
+        }
+        fallback_buffer.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(fallback_buffer.data()), fallback_buffer.size());
+        mapping = fallback_buffer.data();
+        mapping_size = fallback_buffer.size();
+#endif
+    }
+
+public:
+
+    explicit OpeningBook(const std::string& path) {
+        map_file(path);
+        OpeningBookHeader header;
+        std::memcpy(&header, mapping, std::min(mapping_size, sizeof(header)));
+        OpeningBookHeader expected = opening_book_header_for<Score>(header.entry_count);
+        bool compatible = mapping_size >= sizeof(header)
+            && header.magic == expected.magic
+            && header.version == expected.version
+            && header.entry_size == expected.entry_size
+            && header.score_size == expected.score_size
+            && header.score_is_floating_point == expected.score_is_floating_point
+            && mapping_size - sizeof(header) == header.entry_count * sizeof(Entry);
+        if (!compatible) {
+            release();
+            throw std::runtime_error("Error: incompatible opening book " + path);
+        }
+        entries = std::span<const Entry>(reinterpret_cast<const Entry*>(mapping + sizeof(header)), header.entry_count);
+    }
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    OpeningBook(OpeningBook&& other) noexcept
+        : mapping(std::exchange(other.mapping, nullptr))
+        , mapping_size(std::exchange(other.mapping_size, 0))
+        , fallback_buffer(std::move(other.fallback_buffer))
+        , entries(std::exchange(other.entries, {}))
+    {}
+
+    OpeningBook& operator=(OpeningBook&& other) noexcept {
+        if (this != &other) {
+            release();
+            mapping = std::exchange(other.mapping, nullptr);
+            mapping_size = std::exchange(other.mapping_size, 0);
+            fallback_buffer = std::move(other.fallback_buffer);
+            entries = std::exchange(other.entries, {});
+        }
+        return *this;
+    }
+
+    ~OpeningBook() {
+        release();
+    }
+
+    [[nodiscard]] std::optional<Entry> probe(uint64_t key) const {
+        auto entry = std::lower_bound(entries.begin(), entries.end(), key, [](const Entry& entry, uint64_t key) {
+            return entry.key < key;
+        });
+        if (entry == entries.end() || entry->key != key) {
+            return std::nullopt;
+        }
+        return *entry;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return entries.size();
+    }
+};
@@ -0,0 +1,24 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+
+#include "game_board.hpp"
+
+// counts the number of move sequences of exactly `depth` plies starting from `board`,
+// two representations of the same game must agree on it for every depth
+template <game_board Board>
+[[nodiscard]] size_t perft(const Board& board, size_t depth) {
+    if (depth == 0) {
+        return 1;
+    }
+    size_t nodes = 0;
+    for (const Board& child : board.children()) {
+        nodes += perft(child, depth - 1);
+    }
+    return nodes;
+}
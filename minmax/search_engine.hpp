@@ -0,0 +1,1592 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <vector>
+#include <array>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+#include <chrono>
+#include <optional>
+#include <numeric>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <span>
+#include <memory_resource>
+
+#include "game_board.hpp"
+#include "game_score.hpp"
+#include "game_compatibility.hpp"
+#include "transposition_table.hpp"
+#include "work_stealing_pool.hpp"
+#include "move_ordering.hpp"
+#include "search_stats.hpp"
+#include "search_trace.hpp"
+#include "search_policy.hpp"
+#include "arena_resource.hpp"
+#include "opening_book.hpp"
+
+enum class SearchMode {
+    ALPHA_BETA,
+    PRINCIPAL_VARIATION
+};
+
+enum class ParallelMode {
+    YOUNG_BROTHERS_WAIT,
+    LAZY_SMP
+};
+
+// Minimax search with both players sharing a single implementation, parametrized by whose
+// turn it is; everything but the plain search itself is configured by the `Policy`
+template <game_score Score, game_board Board, search_policy Policy = DefaultSearchPolicy<>>
+requires(game_compatibility<Score, Board>)
+struct SearchEngine {
+
+    using Stats = typename Policy::StatsType;
+
+    static constexpr bool USES_ALPHA_BETA_PRUNING = Policy::ALPHA_BETA_PRUNING;
+    static constexpr bool USES_CANCELLATION = Policy::CANCELLATION;
+    static constexpr bool USES_TRANSPOSITION_TABLE = Policy::TRANSPOSITION_TABLE && hashable_game_board<Board>;
+    static constexpr bool USES_MOVE_GENERATION = move_generating_game_board<Board>;
+    static constexpr bool USES_MOVE_ORDERING = Policy::MOVE_ORDERING && USES_MOVE_GENERATION;
+    static constexpr bool USES_BOARD_HINTS = USES_MOVE_ORDERING && move_ordering_game_board<Board>;
+    static constexpr bool USES_SOLVED_POSITIONS = Policy::SOLVED_POSITIONS && solved_game_board<Board>;
+
+    static constexpr bool USES_SEARCH_TRACE = search_trace_policy<Stats, Score>;
+
+    // leaves are only evaluated in batches when none of them could have a solved score instead,
+    // and never in traced searches: the tree is the same, but each leaf gets a record of its own
+    static constexpr bool USES_BATCH_EVALUATION = Policy::BATCH_EVALUATION
+        && batch_evaluating_game_board<Board> && !USES_SOLVED_POSITIONS && !USES_SEARCH_TRACE;
+    static constexpr bool USES_QUIESCENCE = Policy::QUIESCENCE && quiescent_game_board<Board>;
+    static constexpr bool USES_CHILD_ARENAS = !USES_MOVE_GENERATION && allocator_aware_game_board<Board>;
+
+    using TranspositionTableType = std::conditional_t<
+        USES_TRANSPOSITION_TABLE,
+        TranspositionTable<Score>,
+        NoTranspositionTable
+    >;
+
+    [[no_unique_address]] TranspositionTableType transposition_table;
+    SearchMode search_mode = SearchMode::ALPHA_BETA;
+    [[no_unique_address]] Stats stats;
+
+    // only boards that generate moves can be ordered, the other ones are always visited
+    // in the order `children()` produced them (but for the transposition table's best child)
+    MoveOrderingOptions move_ordering;
+
+    // with more than one thread the search follows the young brothers wait concept: the eldest
+    // child of a node is searched first, alone, and its siblings are then spread over a work
+    // stealing pool; only nodes at least `min_split_depth` plies away from the horizon get split
+    size_t thread_count = 1;
+    size_t min_split_depth = 3;
+
+    // lazy smp instead runs the same search on every thread, with the helpers starting at
+    // staggered depths and from rotated root orders; they never exchange anything but the
+    // entries of a shared lock-free transposition table, and only the main thread's result counts
+    ParallelMode parallel_mode = ParallelMode::YOUNG_BROTHERS_WAIT;
+
+    // boards that can't generate moves but build their children through a memory resource get
+    // a recycled arena per level of the search, all of them backed by this resource (which must
+    // be thread safe when searching with multiple threads); the other boards never use it
+    std::pmr::memory_resource* memory_resource = std::pmr::get_default_resource();
+
+    // positions found in the book (only looked up for boards that can be hashed) are answered
+    // straight from it, as long as it searched them at least as deep as requested: the book
+    // must outlive every search that uses it
+    const OpeningBook<Score>* opening_book = nullptr;
+
+    // boards that list their forcing moves (see `quiescent_game_board`) get searched past the
+    // horizon along those moves only, for at most this many plies; zero (the default) stops
+    // every line at the horizon, as boards without forcing moves always do
+    size_t max_quiescence_plies = 0;
+
+    SearchEngine() = default;
+
+    explicit SearchEngine(size_t transposition_table_capacity)
+    requires(USES_TRANSPOSITION_TABLE)
+        : transposition_table(transposition_table_capacity)
+    {}
+
+    [[nodiscard]] const TranspositionStats& transposition_stats() const
+    requires(USES_TRANSPOSITION_TABLE) {
+        return (shared_transposition_table != nullptr)
+            ? shared_transposition_stats
+            : transposition_table.stats();
+    }
+
+    // forgets whatever previous searches left behind (transposition tables included, helpers'
+    // ones too), so that the next search behaves exactly like the one of a fresh engine
+    void clear() {
+        if constexpr (USES_TRANSPOSITION_TABLE) {
+            transposition_table.clear();
+        }
+        move_ordering_tables.clear();
+        if (owned_parallel_context) {
+            for (auto& helper : owned_parallel_context->helpers) {
+                helper->clear();
+            }
+            if (owned_parallel_context->shared_transposition_table) {
+                owned_parallel_context->shared_transposition_table->clear();
+            }
+        }
+    }
+
+    // window the root search starts from: a result that falls outside of it only bounds the
+    // actual score, so the search is run again with the failing bound moved past the result
+    // by `widening_step`, which doubles after every failure (a zero step moves the bound
+    // straight to the limit). The final result is the same as with the full window, only
+    // reached faster the closer the window was to the actual score; once `max_re_searches`
+    // are used up, the bound the last search failed on is reported instead
+    struct AspirationWindow {
+        Score lower = inf_limit<Score>();
+        Score upper = sup_limit<Score>();
+        Score widening_step{};
+        size_t max_re_searches = SIZE_MAX;
+
+        // e.g. around the score of the previous search, when the position changed but little;
+        // even with no margin at all, the expected score itself is within the window
+        [[nodiscard]] static AspirationWindow around(Score expected_score, Score margin) {
+            return AspirationWindow {
+                .lower = std::min(lower_score_by(expected_score, margin), prev_score(expected_score)),
+                .upper = std::max(raise_score_by(expected_score, margin), next_score(expected_score)),
+                .widening_step = margin
+            };
+        }
+    };
+
+    struct AnalysisResult {
+        Board best_move;
+        Score score;
+
+        // the score is exact unless the aspiration window gave up (see `max_re_searches`)
+        Bound bound = Bound::EXACT;
+        size_t depth = 0;
+
+        // the line both players are expected to follow, starting from `best_move`: it's read
+        // back from the transposition table, so it may stop short of the search depth
+        std::vector<Board> principal_variation;
+        size_t aspiration_re_searches = 0;
+    };
+
+    // iterative deepening searches every iteration but the first through an aspiration window
+    // of this margin around the score of the previous iteration (zero means the full window)
+    Score aspiration_margin{};
+
+    [[nodiscard]] Board find_best_move(size_t max_depth, const Board& board) {
+        return analyze(max_depth, board).best_move;
+    }
+
+    // same search as `find_best_move`, also reporting the minimax value of the position
+    [[nodiscard]] AnalysisResult analyze(size_t max_depth, const Board& board) {
+        return analyze(max_depth, board, AspirationWindow{});
+    }
+
+    [[nodiscard]] AnalysisResult analyze(size_t max_depth, const Board& board, const AspirationWindow& window) {
+        auto children = root_children(max_depth, board);
+        stats = Stats{};
+        if (auto entry = probe_opening_book(board, children.size(), max_depth)) {
+            return remember_line(board, result_from_book<AnalysisResult>(*entry, children));
+        }
+        seed_root_order(board, children);
+        prepare_parallel_search();
+        std::vector<Score> scores;
+        return remember_line(board, with_lazy_helpers(board, children, max_depth, [&] {
+            return search_to_depth(max_depth, board, children, scores, window);
+        }));
+    }
+
+    struct IterativeDeepeningResult {
+        Board best_move;
+        size_t completed_depth = 0;
+        Score score{};
+
+        // whether the deadline stopped the search before `max_depth` or the end of the game
+        bool interrupted = false;
+        std::vector<Board> principal_variation;
+        size_t aspiration_re_searches = 0;
+    };
+
+    // deepens one ply at a time until the time budget runs out, the whole game tree has been
+    // explored or `max_depth` is reached; the first iteration is always run to completion
+    // so that a move is available, later ones are abandoned as soon as the deadline expires
+    template <typename Rep, typename Period>
+    [[nodiscard]] IterativeDeepeningResult find_best_move_within(
+        std::chrono::duration<Rep, Period> time_budget, const Board& board, size_t max_depth = SIZE_MAX
+    )
+    requires(USES_CANCELLATION) {
+        return search_until(std::chrono::steady_clock::now() + time_budget, board, max_depth);
+    }
+
+    // Handle to a search running in the background, typically on the opponent's time: the
+    // position it searches is the one expected after the engine's move, so that whichever
+    // reply comes, its subtree is likely to be in the transposition table already (and the
+    // expected one gets searched first, see `seed_root_order`). The engine belongs to the
+    // background search until the handle is stopped, waited for or destroyed.
+    class Pondering {
+
+        struct Shared {
+            std::atomic<bool> stop_requested = false;
+            std::atomic<bool> finished = false;
+            std::optional<IterativeDeepeningResult> result;
+            std::exception_ptr error;
+            std::thread thread;
+        };
+
+        std::unique_ptr<Shared> shared;
+
+    public:
+
+        Pondering(SearchEngine& engine, const Board& board, size_t max_depth)
+            : shared(std::make_unique<Shared>())
+        {
+            shared->thread = std::thread([&engine, board, max_depth, state = shared.get()] {
+                const std::atomic<bool>* previous_stop_signal = std::exchange(engine.stop_signal, &state->stop_requested);
+                try {
+                    state->result = engine.search_until(std::chrono::steady_clock::time_point::max(), board, max_depth);
+                }
+                catch (const SearchCancelled&) {}
+                catch (...) {
+                    state->error = std::current_exception();
+                }
+                engine.stop_signal = previous_stop_signal;
+                state->finished = true;
+            });
+        }
+
+        Pondering(Pondering&&) noexcept = default;
+        Pondering& operator=(Pondering&&) = delete;
+
+        ~Pondering() {
+            if (shared && shared->thread.joinable()) {
+                shared->stop_requested = true;
+                shared->thread.join();
+            }
+        }
+
+        // whether `wait` would return right away
+        [[nodiscard]] bool ready() const {
+            return shared->finished.load();
+        }
+
+        // deepest iteration completed by the background search, if any
+        [[nodiscard]] std::optional<IterativeDeepeningResult> wait() {
+            if (shared->thread.joinable()) {
+                shared->thread.join();
+            }
+            if (shared->error) {
+                std::rethrow_exception(std::exchange(shared->error, nullptr));
+            }
+            return shared->result;
+        }
+
+        std::optional<IterativeDeepeningResult> stop() {
+            shared->stop_requested = true;
+            return wait();
+        }
+    };
+
+    // iterative deepening with no time budget, until `max_depth` or the end of the game
+    [[nodiscard]] Pondering ponder(const Board& board, size_t max_depth = SIZE_MAX)
+    requires(USES_CANCELLATION) {
+        return Pondering(*this, board, max_depth);
+    }
+
+    // independent positions are spread over `thread_count` workers, each one searching a whole
+    // position at a time through its own engine: boards that can be hashed share a single
+    // lock-free transposition table for the whole batch (and the batches that follow), while
+    // every worker keeps its root buffers and move ordering tables from one of its positions
+    // to the next. Positions where the game is already over get no result, without affecting
+    // the others
+    [[nodiscard]] std::vector<std::optional<AnalysisResult>> analyze_batch(std::span<const Board> boards, size_t max_depth) {
+        ensure_searchable_depth(max_depth);
+        return run_batch<AnalysisResult>(boards, [max_depth](SearchEngine& worker, const Board& board, BatchScratch& scratch) {
+            if (auto entry = worker.probe_opening_book(board, scratch.children.size(), max_depth)) {
+                return result_from_book<AnalysisResult>(*entry, scratch.children);
+            }
+            return worker.search_to_depth(max_depth, board, scratch.children, scratch.scores, AspirationWindow{});
+        });
+    }
+
+    // the time budget applies to every position on its own, counting from when its search starts
+    template <typename Rep, typename Period>
+    [[nodiscard]] std::vector<std::optional<IterativeDeepeningResult>> analyze_batch_within(
+        std::chrono::duration<Rep, Period> time_budget_per_position,
+        std::span<const Board> boards, size_t max_depth = SIZE_MAX
+    )
+    requires(USES_CANCELLATION) {
+        ensure_searchable_depth(max_depth);
+        return run_batch<IterativeDeepeningResult>(boards, [&](SearchEngine& worker, const Board& board, BatchScratch& scratch) {
+            auto start_time = std::chrono::steady_clock::now();
+            if (auto entry = worker.probe_opening_book(board, scratch.children.size(), 1)) {
+                return result_from_book<IterativeDeepeningResult>(*entry, scratch.children);
+            }
+            return worker.deepen_within(
+                start_time + time_budget_per_position, board, scratch.children, scratch.scores, max_depth
+            );
+        });
+    }
+
+    struct State {
+        Score global_maximum = inf_limit<Score>(); // alpha
+        Score global_minimum = sup_limit<Score>(); // beta
+    };
+
+    [[nodiscard]] Score maximizing_score(size_t max_depth, const Board& board, State state) {
+        return node_score<true>(max_depth, board, state);
+    }
+
+    [[nodiscard]] Score minimizing_score(size_t max_depth, const Board& board, State state) {
+        return node_score<false>(max_depth, board, state);
+    }
+
+private:
+
+    template <typename GB>
+    struct move_type_of {
+        using type = size_t;
+    };
+
+    template <move_generating_game_board GB>
+    struct move_type_of<GB> {
+        using type = typename GB::move_t;
+    };
+
+    using MoveOrderingTablesType = std::conditional_t<
+        USES_MOVE_ORDERING,
+        MoveOrderingTables<typename move_type_of<Board>::type>,
+        NoMoveOrderingTables
+    >;
+
+    [[no_unique_address]] MoveOrderingTablesType move_ordering_tables;
+
+    static constexpr size_t NO_CHILD = SIZE_MAX;
+    static constexpr size_t MAX_PRIORITIZED_CHILDREN = 64;
+
+    // children get visited by decreasing priority: the transposition table's best child
+    // comes first, then the killer moves, then the others by history score and board hint
+    struct ChildPriority {
+        int tier;
+        uint64_t history_score;
+        int64_t board_hint;
+
+        auto operator<=>(const ChildPriority&) const = default;
+    };
+
+    struct ChildSelector {
+        size_t children_count = 0;
+        size_t first_child_index = NO_CHILD;
+        size_t visited_count = 0;
+        bool prioritized = false;
+        uint64_t visited = 0;
+        std::array<ChildPriority, MAX_PRIORITIZED_CHILDREN> priorities;
+
+        [[nodiscard]] size_t next() {
+            size_t order = visited_count++;
+            if (!prioritized) {
+                return visiting_order(order, first_child_index, children_count);
+            }
+            size_t best_index = NO_CHILD;
+            for (size_t index = 0; index < children_count; index++) {
+                bool available = !((visited >> index) & 1);
+                if (available && (best_index == NO_CHILD || priorities[index] > priorities[best_index])) {
+                    best_index = index;
+                }
+            }
+            visited |= uint64_t(1) << best_index;
+            return best_index;
+        }
+    };
+
+    [[nodiscard]] ChildSelector select_children(
+        const Board& board, const auto& children, size_t first_child_index, size_t max_depth, bool maximizing
+    ) const {
+        ChildSelector selector;
+        selector.children_count = children.size();
+        selector.first_child_index = first_child_index;
+        if constexpr (USES_MOVE_ORDERING) {
+            bool hints = USES_BOARD_HINTS && move_ordering.board_hints;
+            if (!(hints || move_ordering.killer_moves || move_ordering.history_heuristic)) {
+                return selector;
+            }
+            if (children.size() > MAX_PRIORITIZED_CHILDREN) {
+                return selector;
+            }
+            selector.prioritized = true;
+            for (size_t index = 0; index < children.size(); index++) {
+                const auto& move = children[index];
+                ChildPriority& priority = selector.priorities[index];
+                priority.tier = (index == first_child_index) ? 3 : 0;
+                if (move_ordering.killer_moves && priority.tier == 0) {
+                    priority.tier = move_ordering_tables.killer_rank(ply_of(max_depth), move);
+                }
+                priority.history_score = (move_ordering.history_heuristic)
+                    ? move_ordering_tables.history_score(maximizing, move)
+                    : 0;
+                priority.board_hint = 0;
+                if constexpr (USES_BOARD_HINTS) {
+                    priority.board_hint = (hints) ? static_cast<int64_t>(board.move_priority(move)) : 0;
+                }
+            }
+        }
+        return selector;
+    }
+
+    void record_cutoff(size_t max_depth, bool maximizing, const auto& children, size_t child_index) {
+        if constexpr (USES_MOVE_ORDERING) {
+            move_ordering_tables.record_cutoff(
+                ply_of(max_depth), max_depth, maximizing, children[child_index], move_ordering
+            );
+        }
+    }
+
+    struct SearchTimeout {};
+    struct SearchCancelled {};
+
+    // node whose children are being searched by several workers at once: the window
+    // and the best result so far are shared, and a cutoff cancels the siblings still running
+    struct SplitPoint {
+        const SplitPoint* parent = nullptr;
+        std::atomic<bool> cancelled = false;
+        std::mutex mutex;
+        State state;
+        Score best_score;
+        size_t best_child_index = 0;
+        bool horizon_reached = false;
+    };
+
+    // every worker of the pool searches through its own engine, the one for the thread that
+    // started the search being the engine that owns the context; all of them probe and store
+    // through the shared transposition table, so that no worker proves again what another did
+    struct ParallelContext {
+        WorkStealingPool pool;
+        SearchEngine* owner = nullptr;
+        std::vector<std::unique_ptr<SearchEngine>> helpers;
+        std::unique_ptr<SharedTranspositionTable<Score>> shared_transposition_table;
+        std::optional<TaskGroup> lazy_helpers;
+        std::atomic<bool> stop_lazy_helpers = false;
+
+        explicit ParallelContext(size_t thread_count) : pool(thread_count) {}
+
+        [[nodiscard]] SearchEngine& engine_of(size_t worker) {
+            return (worker == 0) ? *owner : *helpers[worker - 1];
+        }
+    };
+
+    std::unique_ptr<ParallelContext> owned_parallel_context;
+    ParallelContext* parallel_context = nullptr;
+    const SplitPoint* split_point = nullptr;
+
+    SharedTranspositionTable<Score>* shared_transposition_table = nullptr;
+    TranspositionStats shared_transposition_stats;
+    const std::atomic<bool>* stop_signal = nullptr;
+
+    static constexpr size_t CLOCK_CHECK_INTERVAL = 1024;
+
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    size_t nodes_before_clock_check = CLOCK_CHECK_INTERVAL;
+    bool horizon_reached = false;
+    size_t iteration_depth = 0;
+
+    // distance from the root of a node searched with the given remaining depth
+    [[nodiscard]] size_t ply_of(size_t max_depth) const {
+        return (max_depth <= iteration_depth) ? iteration_depth - max_depth + 1 : 0;
+    }
+
+    // reading the clock is way more expensive than visiting a node, so it's done only
+    // once every `CLOCK_CHECK_INTERVAL` nodes
+    void check_deadline() {
+        if (!USES_CANCELLATION || !deadline.has_value() || --nodes_before_clock_check != 0) {
+            return;
+        }
+        nodes_before_clock_check = CLOCK_CHECK_INTERVAL;
+        if (std::chrono::steady_clock::now() >= *deadline) {
+            throw SearchTimeout{};
+        }
+    }
+
+    // the side to move only decides which way scores are compared and which bound of the
+    // window they raise: the maximizing player raises alpha, the minimizing one lowers beta
+    template <bool Maximizing>
+    [[nodiscard]] static bool improves(Score candidate, Score best) {
+        if constexpr (Maximizing) {
+            return candidate > best;
+        }
+        else {
+            return candidate < best;
+        }
+    }
+
+    template <bool Maximizing>
+    static void tighten(State& state, Score score) {
+        if constexpr (Maximizing) {
+            state.global_maximum = std::max(score, state.global_maximum);
+        }
+        else {
+            state.global_minimum = std::min(score, state.global_minimum);
+        }
+    }
+
+    // tracing stats policies (see `search_trace.hpp`) get every node once it has been searched
+    template <bool Maximizing>
+    [[nodiscard]] Score node_score(size_t max_depth, const Board& board, State state) {
+        size_t cutoff_order = NO_CHILD;
+        Score score = search_node<Maximizing>(max_depth, board, state, cutoff_order);
+        if constexpr (USES_SEARCH_TRACE) {
+            uint64_t hash = 0;
+            if constexpr (hashable_game_board<Board>) {
+                hash = board.hash();
+            }
+            stats.on_node_searched(SearchTraceRecord<Score> {
+                .hash = hash,
+                .alpha = state.global_maximum,
+                .beta = state.global_minimum,
+                .score = score,
+                .ply = static_cast<uint16_t>(std::min<size_t>(ply_of(max_depth), UINT16_MAX)),
+                .depth = static_cast<uint16_t>(std::min<size_t>(max_depth, UINT16_MAX)),
+                .cutoff_order = static_cast<uint8_t>(std::min<size_t>(cutoff_order, SearchTraceRecord<Score>::NO_CUTOFF))
+            });
+        }
+        return score;
+    }
+
+    template <bool Maximizing>
+    [[nodiscard]] Score search_node(size_t max_depth, const Board& board, State state, size_t& cutoff_order) {
+        check_deadline();
+        check_cancelled();
+        stats.on_node(ply_of(max_depth));
+        size_t first_child_index = NO_CHILD;
+        if (max_depth != 0 && probe_transposition_table(max_depth, board, state, first_child_index)) {
+            return state.global_maximum;
+        }
+        if constexpr (USES_SOLVED_POSITIONS) {
+            if (auto solved_score = board.solved_score(); solved_score.has_value()) {
+                stats.on_leaf();
+                return *solved_score;
+            }
+        }
+        [[maybe_unused]] auto arena_frame = enter_arena_frame();
+        auto children = expand(board);
+        if (children.empty()) {
+            stats.on_leaf();
+            return board.evaluate();
+        }
+        if (max_depth == 0) {
+            return quiescence_score<Maximizing>(board, state, 0);
+        }
+        const State initial_state = state;
+        const bool horizon_reached_before = std::exchange(horizon_reached, false);
+        size_t best_child_index = 0;
+        Score best_score = (Maximizing) ? inf_limit<Score>() : sup_limit<Score>();
+        auto selector = select_children(board, children, first_child_index, max_depth, Maximizing);
+        LeafBatch leaves;
+        for (size_t order = 0; order < children.size(); order++) {
+            if (order == 1) {
+                evaluate_leaves(max_depth, board, children.size(), leaves);
+            }
+            if (order == 1 && !leaves.evaluated && should_split(max_depth)) {
+                search_siblings_in_parallel<Maximizing>(
+                    max_depth - 1, board, children, selector, state, best_score, best_child_index
+                );
+                break;
+            }
+            size_t child_index = selector.next();
+            Score score = (leaves.evaluated)
+                ? leaf_score(leaves, child_index)
+                : child_score<Maximizing>(max_depth - 1, child_at(board, children, child_index), state, order == 0);
+            if (order == 0 || improves<Maximizing>(score, best_score)) {
+                best_score = score;
+                best_child_index = child_index;
+            }
+            if constexpr (USES_ALPHA_BETA_PRUNING) {
+                tighten<Maximizing>(state, best_score);
+                if (state.global_minimum <= state.global_maximum) {
+                    record_cutoff(max_depth, Maximizing, children, child_index);
+                    stats.on_cutoff(order);
+                    cutoff_order = order;
+                    break;
+                }
+            }
+        }
+        store_transposition_table(max_depth, board, initial_state, best_score, best_child_index);
+        horizon_reached |= horizon_reached_before;
+        return best_score;
+    }
+
+    // the position is evaluated, unless it still has forcing moves and the cap allows to
+    // search them: then it takes the best of their scores, there's no standing pat on the
+    // evaluation since the board vouches for the best move being among them. Nothing gets
+    // stored in the transposition table past the horizon
+    template <bool Maximizing>
+    [[nodiscard]] Score quiescence_score(const Board& board, State state, size_t quiescence_ply) {
+        if constexpr (USES_QUIESCENCE) {
+            if (quiescence_ply < max_quiescence_plies) {
+                auto forcing_moves = board.forcing_moves();
+                if (!forcing_moves.empty()) {
+                    return forcing_moves_score<Maximizing>(board, forcing_moves, state, quiescence_ply);
+                }
+            }
+        }
+        horizon_reached = true;
+        stats.on_leaf();
+        return board.evaluate();
+    }
+
+    template <bool Maximizing>
+    [[nodiscard]] Score forcing_moves_score(
+        const Board& board, const auto& forcing_moves, State state, size_t quiescence_ply
+    ) {
+        Score best_score = (Maximizing) ? inf_limit<Score>() : sup_limit<Score>();
+        for (size_t order = 0; order < forcing_moves.size(); order++) {
+            Score score = quiescence_node_score<!Maximizing>(board.make(forcing_moves[order]), state, quiescence_ply + 1);
+            if (order == 0 || improves<Maximizing>(score, best_score)) {
+                best_score = score;
+            }
+            if constexpr (USES_ALPHA_BETA_PRUNING) {
+                tighten<Maximizing>(state, best_score);
+                if (state.global_minimum <= state.global_maximum) {
+                    stats.on_cutoff(order);
+                    break;
+                }
+            }
+        }
+        return best_score;
+    }
+
+    template <bool Maximizing>
+    [[nodiscard]] Score quiescence_node_score(const Board& board, State state, size_t quiescence_ply) {
+        check_deadline();
+        check_cancelled();
+        stats.on_node(ply_of(0) + quiescence_ply);
+        if constexpr (USES_SOLVED_POSITIONS) {
+            if (auto solved_score = board.solved_score(); solved_score.has_value()) {
+                stats.on_leaf();
+                return *solved_score;
+            }
+        }
+        if (board.moves().empty()) {
+            stats.on_leaf();
+            return board.evaluate();
+        }
+        return quiescence_score<Maximizing>(board, state, quiescence_ply);
+    }
+
+    static constexpr size_t MAX_BATCH_EVALUATED_CHILDREN = 64;
+
+    struct LeafBatch {
+        bool evaluated = false;
+        uint64_t ongoing_games = 0;
+        std::array<Score, MAX_BATCH_EVALUATED_CHILDREN> scores;
+    };
+
+    // children of a node right above the horizon are all leaves, so their scores can be
+    // computed at once: that's only done once the first child failed to cause a cutoff,
+    // since most of the nodes where it does would waste the rest of the batch (and never
+    // with quiescence, where some of the children may be searched further)
+    void evaluate_leaves(size_t max_depth, const Board& board, size_t children_count, LeafBatch& leaves) const {
+        if constexpr (USES_BATCH_EVALUATION) {
+            bool leaves_only = !USES_QUIESCENCE || max_quiescence_plies == 0;
+            if (max_depth == 1 && leaves_only && children_count <= MAX_BATCH_EVALUATED_CHILDREN) {
+                leaves.ongoing_games = board.evaluate_children(std::span(leaves.scores).first(children_count));
+                leaves.evaluated = true;
+            }
+        }
+    }
+
+    // same bookkeeping as the visit of the leaf by `node_score`, with its score already known:
+    // a leaf is the same whatever the window, so a null window never needs a re-search
+    [[nodiscard]] Score leaf_score(const LeafBatch& leaves, size_t child_index) {
+        check_deadline();
+        check_cancelled();
+        stats.on_node(ply_of(0));
+        stats.on_leaf();
+        horizon_reached |= ((leaves.ongoing_games >> child_index) & 1) != 0;
+        return leaves.scores[child_index];
+    }
+
+    // searches a child of a node of the `Maximizing` player: in principal variation mode every
+    // child but the first one is searched with a null window first (right above alpha for the
+    // maximizing player, right below beta for the minimizing one), which only proves whether it
+    // can improve on the current bound, and gets searched again with the full window when it does
+    template <bool Maximizing>
+    [[nodiscard]] Score child_score(size_t max_depth, const Board& child, State state, bool first_child) {
+        if (!USES_ALPHA_BETA_PRUNING || first_child || search_mode == SearchMode::ALPHA_BETA) {
+            return node_score<!Maximizing>(max_depth, child, state);
+        }
+        stats.on_null_window_search();
+        State null_window = (Maximizing)
+            ? State { state.global_maximum, next_score(state.global_maximum) }
+            : State { prev_score(state.global_minimum), state.global_minimum };
+        Score score = node_score<!Maximizing>(max_depth, child, null_window);
+        if (score > state.global_maximum && score < state.global_minimum) {
+            stats.on_re_search();
+            score = node_score<!Maximizing>(max_depth, child, state);
+        }
+        return score;
+    }
+
+    void check_cancelled() const {
+        if constexpr (!USES_CANCELLATION) {
+            return;
+        }
+        if (stop_signal != nullptr && stop_signal->load(std::memory_order_relaxed)) {
+            throw SearchCancelled{};
+        }
+        for (const SplitPoint* current = split_point; current != nullptr; current = current->parent) {
+            if (current->cancelled.load(std::memory_order_relaxed)) {
+                throw SearchCancelled{};
+            }
+        }
+    }
+
+    [[nodiscard]] bool should_split(size_t max_depth) const {
+        return USES_CANCELLATION && parallel_context != nullptr && max_depth >= min_split_depth;
+    }
+
+    [[nodiscard]] bool lazy_smp_enabled() const {
+        return USES_TRANSPOSITION_TABLE && USES_CANCELLATION
+            && thread_count > 1 && parallel_mode == ParallelMode::LAZY_SMP;
+    }
+
+    void prepare_parallel_search() {
+        if (thread_count <= 1) {
+            owned_parallel_context.reset();
+            parallel_context = nullptr;
+            shared_transposition_table = nullptr;
+            return;
+        }
+        if (!owned_parallel_context || owned_parallel_context->pool.size() != thread_count) {
+            owned_parallel_context.reset();
+            owned_parallel_context = std::make_unique<ParallelContext>(thread_count);
+            for (size_t worker = 1; worker < thread_count; worker++) {
+                if constexpr (USES_TRANSPOSITION_TABLE) {
+                    owned_parallel_context->helpers.push_back(
+                        std::make_unique<SearchEngine>(transposition_table.capacity())
+                    );
+                }
+                else {
+                    owned_parallel_context->helpers.push_back(std::make_unique<SearchEngine>());
+                }
+            }
+        }
+        ParallelContext* context = owned_parallel_context.get();
+        context->owner = this;
+        bool splits_nodes = USES_CANCELLATION && parallel_mode == ParallelMode::YOUNG_BROTHERS_WAIT;
+        shared_transposition_table = nullptr;
+        if (lazy_smp_enabled() || splits_nodes) {
+            share_transposition_table(*context);
+        }
+        parallel_context = (splits_nodes) ? context : nullptr;
+        for (auto& helper : context->helpers) {
+            helper->parallel_context = parallel_context;
+            helper->shared_transposition_table = shared_transposition_table;
+            helper->search_mode = search_mode;
+            helper->move_ordering = move_ordering;
+            helper->move_ordering_tables.clear();
+            helper->min_split_depth = min_split_depth;
+            helper->memory_resource = memory_resource;
+            helper->opening_book = opening_book;
+            helper->max_quiescence_plies = max_quiescence_plies;
+            helper->stats = Stats{};
+            helper->deadline.reset();
+            helper->stop_signal = stop_signal;
+        }
+    }
+
+    void share_transposition_table(ParallelContext& context) {
+        if constexpr (USES_TRANSPOSITION_TABLE) {
+            if (!context.shared_transposition_table) {
+                context.shared_transposition_table = std::make_unique<SharedTranspositionTable<Score>>(
+                    transposition_table.capacity()
+                );
+            }
+            shared_transposition_table = context.shared_transposition_table.get();
+        }
+    }
+
+    // batches never split nodes: every worker searches whole positions on its own,
+    // only sharing the transposition table with the others
+    void prepare_batch_analysis() {
+        prepare_parallel_search();
+        parallel_context = nullptr;
+        if (!owned_parallel_context) {
+            return;
+        }
+        share_transposition_table(*owned_parallel_context);
+        for (auto& helper : owned_parallel_context->helpers) {
+            helper->parallel_context = nullptr;
+            helper->shared_transposition_table = shared_transposition_table;
+        }
+    }
+
+    void start_lazy_helpers(const Board& board, const std::vector<Board>& children, size_t max_depth) {
+        if (!lazy_smp_enabled()) {
+            return;
+        }
+        ParallelContext& context = *owned_parallel_context;
+        context.stop_lazy_helpers = false;
+        context.lazy_helpers.emplace();
+        for (size_t helper_index = 1; helper_index < thread_count; helper_index++) {
+            context.lazy_helpers->run(context.pool, [&context, &board, children, max_depth, helper_index] {
+                SearchEngine& worker = context.engine_of(WorkStealingPool::current_worker());
+                worker.run_lazy_helper(helper_index, board, children, max_depth, context.stop_lazy_helpers);
+            });
+        }
+    }
+
+    void stop_lazy_helpers() {
+        if (!lazy_smp_enabled() || !owned_parallel_context->lazy_helpers.has_value()) {
+            return;
+        }
+        ParallelContext& context = *owned_parallel_context;
+        context.stop_lazy_helpers = true;
+        context.lazy_helpers->wait(context.pool);
+        context.lazy_helpers.reset();
+    }
+
+    // iterative deepening whose only purpose is filling the shared transposition table: odd
+    // helpers skip the first depth and every helper starts from its own rotation of the root
+    void run_lazy_helper(
+        size_t helper_index, const Board& board, std::vector<Board> children,
+        size_t max_depth, const std::atomic<bool>& stop
+    ) {
+        const std::atomic<bool>* previous_stop_signal = std::exchange(stop_signal, &stop);
+        std::rotate(children.begin(), children.begin() + helper_index % children.size(), children.end());
+        std::vector<Score> scores(children.size());
+        try {
+            for (size_t depth = 1 + helper_index % 2; depth <= max_depth; depth++) {
+                horizon_reached = false;
+                static_cast<void>(search_root(depth, board, children, scores));
+                if (!horizon_reached) {
+                    break;
+                }
+                sort_by_scores(board.current_player_is_maximizing(), children, scores);
+            }
+        }
+        catch (const SearchCancelled&) {}
+        catch (const SearchTimeout&) {}
+        stop_signal = previous_stop_signal;
+    }
+
+    void collect_helpers_stats() {
+        if (!owned_parallel_context) {
+            return;
+        }
+        for (auto& helper : owned_parallel_context->helpers) {
+            stats.merge(std::exchange(helper->stats, Stats{}));
+            auto helper_transposition_stats = std::exchange(helper->shared_transposition_stats, TranspositionStats{});
+            shared_transposition_stats.hits += helper_transposition_stats.hits;
+            shared_transposition_stats.misses += helper_transposition_stats.misses;
+            shared_transposition_stats.overwrites += helper_transposition_stats.overwrites;
+        }
+    }
+
+    // runs a search on behalf of a split point, restoring whatever the worker was doing before
+    // it started helping; yields nothing when the search got cancelled by a cutoff
+    template <typename Search>
+    [[nodiscard]] std::optional<Score> search_as_task(const SplitPoint* split, bool& task_horizon_reached, Search&& search) {
+        const SplitPoint* previous_split_point = std::exchange(split_point, split);
+        const bool previous_horizon_reached = std::exchange(horizon_reached, false);
+        std::optional<Score> score;
+        try {
+            score = search();
+        }
+        catch (const SearchCancelled&) {}
+        catch (...) {
+            split_point = previous_split_point;
+            horizon_reached = previous_horizon_reached;
+            throw;
+        }
+        task_horizon_reached = horizon_reached;
+        split_point = previous_split_point;
+        horizon_reached = previous_horizon_reached;
+        return score;
+    }
+
+    // searches the siblings of an eldest child that has already been searched, one task
+    // each; `state`, `best_score` and `best_child_index` are updated with their results
+    template <bool Maximizing>
+    void search_siblings_in_parallel(
+        size_t child_depth, const Board& board, const auto& children, ChildSelector& selector,
+        State& state, Score& best_score, size_t& best_child_index
+    ) {
+        SplitPoint split;
+        split.parent = split_point;
+        split.state = state;
+        split.best_score = best_score;
+        split.best_child_index = best_child_index;
+        TaskGroup siblings;
+        for (size_t order = 1; order < children.size(); order++) {
+            size_t child_index = selector.next();
+            siblings.run(parallel_context->pool, [&, child_index] {
+                SearchEngine& worker = parallel_context->engine_of(WorkStealingPool::current_worker());
+                worker.template search_sibling<Maximizing>(
+                    split, child_depth, child_at(board, children, child_index), child_index
+                );
+            });
+        }
+        siblings.wait(parallel_context->pool);
+        check_cancelled();
+        state = split.state;
+        best_score = split.best_score;
+        best_child_index = split.best_child_index;
+        horizon_reached |= split.horizon_reached;
+    }
+
+    template <bool Maximizing>
+    void search_sibling(SplitPoint& split, size_t child_depth, const Board& child, size_t child_index) {
+        State window;
+        {
+            std::lock_guard lock(split.mutex);
+            if (split.cancelled) {
+                return;
+            }
+            window = split.state;
+        }
+        bool task_horizon_reached = false;
+        auto score = search_as_task(&split, task_horizon_reached, [&] {
+            return child_score<Maximizing>(child_depth, child, window, false);
+        });
+        if (!score.has_value()) {
+            return;
+        }
+        std::lock_guard lock(split.mutex);
+        split.horizon_reached |= task_horizon_reached;
+        if (improves<Maximizing>(*score, split.best_score)) {
+            split.best_score = *score;
+            split.best_child_index = child_index;
+            tighten<Maximizing>(split.state, *score);
+        }
+        if (split.state.global_minimum <= split.state.global_maximum) {
+            split.cancelled = true;
+        }
+    }
+
+    // parallel counterpart of the root loop in `search_root`: siblings get bounded by the best
+    // score known when they start, taking into account whether they come before or after the
+    // child holding it, so that ties are broken exactly as in the serial search
+    template <bool Maximizing>
+    [[nodiscard]] size_t search_root_in_parallel(
+        size_t max_depth, const std::vector<Board>& children, std::vector<Score>& scores, State root_window
+    ) {
+        scores[0] = child_score<Maximizing>(max_depth, children[0], root_window, true);
+        struct {
+            std::mutex mutex;
+            Score score;
+            size_t index = 0;
+            bool horizon_reached = false;
+        } best;
+        best.score = scores[0];
+        TaskGroup siblings;
+        for (size_t index = 1; index < children.size(); index++) {
+            siblings.run(parallel_context->pool, [&, index] {
+                SearchEngine& worker = parallel_context->engine_of(WorkStealingPool::current_worker());
+                State window;
+                {
+                    std::lock_guard lock(best.mutex);
+                    window = (Maximizing)
+                        ? State {
+                            std::max((best.index < index) ? best.score : prev_score(best.score), root_window.global_maximum),
+                            root_window.global_minimum
+                        }
+                        : State {
+                            root_window.global_maximum,
+                            std::min((best.index < index) ? next_score(best.score) : best.score, root_window.global_minimum)
+                        };
+                }
+                // the root already failed past its window, which no other child can change
+                if (!(window.global_maximum < window.global_minimum)) {
+                    scores[index] = (Maximizing) ? inf_limit<Score>() : sup_limit<Score>();
+                    return;
+                }
+                bool task_horizon_reached = false;
+                auto score = worker.search_as_task(nullptr, task_horizon_reached, [&] {
+                    return worker.template child_score<Maximizing>(max_depth, children[index], window, false);
+                });
+                // only a stop request gets a root child cancelled, the owner throws it below
+                if (!score.has_value()) {
+                    return;
+                }
+                scores[index] = *score;
+                std::lock_guard lock(best.mutex);
+                best.horizon_reached |= task_horizon_reached;
+                bool later_tie = (Maximizing) ? index < best.index : index > best.index;
+                if (improves<Maximizing>(*score, best.score) || (score_traits<Score>::equal(*score, best.score) && later_tie)) {
+                    best.score = *score;
+                    best.index = index;
+                }
+            });
+        }
+        siblings.wait(parallel_context->pool);
+        check_cancelled();
+        horizon_reached |= best.horizon_reached;
+        size_t best_move_index = 0;
+        for (size_t index = 1; index < children.size(); index++) {
+            if ((scores[index] > scores[best_move_index]) == Maximizing) {
+                best_move_index = index;
+            }
+        }
+        return best_move_index;
+    }
+
+    [[nodiscard]] std::optional<OpeningBookEntry<Score>> probe_opening_book(
+        const Board& board, size_t children_count, size_t min_depth
+    ) const {
+        if constexpr (hashable_game_board<Board>) {
+            if (opening_book == nullptr) {
+                return std::nullopt;
+            }
+            auto entry = opening_book->probe(board.hash());
+            if (entry.has_value() && entry->depth >= min_depth && entry->best_child_index < children_count) {
+                return entry;
+            }
+        }
+        return std::nullopt;
+    }
+
+    template <typename Result>
+    [[nodiscard]] static Result result_from_book(const OpeningBookEntry<Score>& entry, const std::vector<Board>& children) {
+        Result result { .best_move = children[entry.best_child_index] };
+        result.score = entry.score;
+        result.principal_variation = { result.best_move };
+        if constexpr (std::is_same_v<Result, AnalysisResult>) {
+            result.depth = entry.depth;
+        }
+        else {
+            result.completed_depth = entry.depth;
+        }
+        return result;
+    }
+
+    // root followed by the expected line of the last search, see `seed_root_order`
+    std::vector<Board> previous_line;
+
+    template <typename Result>
+    [[nodiscard]] Result remember_line(const Board& board, Result result) {
+        if constexpr (USES_TRANSPOSITION_TABLE) {
+            previous_line.clear();
+            previous_line.push_back(board);
+            previous_line.insert(previous_line.end(), result.principal_variation.begin(), result.principal_variation.end());
+        }
+        return result;
+    }
+
+    // when the root lies on the line expected by the last search (the opponent answered as
+    // predicted, or the same position gets analyzed again) the move that line continues with
+    // is searched first: its bounds then prune the most, even if its transposition table entry
+    // has been overwritten in the meanwhile
+    void seed_root_order(const Board& board, std::vector<Board>& children) const {
+        if constexpr (USES_TRANSPOSITION_TABLE) {
+            for (size_t ply = 0; ply + 1 < previous_line.size(); ply++) {
+                if (previous_line[ply].hash() != board.hash()) {
+                    continue;
+                }
+                uint64_t expected_hash = previous_line[ply + 1].hash();
+                auto expected = std::find_if(children.begin(), children.end(), [&](const Board& child) {
+                    return child.hash() == expected_hash;
+                });
+                std::rotate(children.begin(), expected, (expected == children.end()) ? expected : expected + 1);
+                return;
+            }
+        }
+    }
+
+    // follows the best children recorded in the transposition table, as long as they come
+    // from entries that actually had a best child (those that failed low only had a guess)
+    // and that were searched at least as deep as this search reached them: shallower ones
+    // are left over from earlier searches (or pondering), whose moves this one never made
+    [[nodiscard]] std::vector<Board> principal_variation_from(const Board& best_move, size_t max_depth) const {
+        std::vector<Board> line { best_move };
+        if constexpr (USES_TRANSPOSITION_TABLE) {
+            while (line.size() < max_depth) {
+                const Board& board = line.back();
+                size_t remaining_depth = max_depth - line.size();
+                auto entry = (shared_transposition_table != nullptr)
+                    ? shared_transposition_table->peek(board.hash())
+                    : transposition_table.peek(board.hash());
+                if (!entry.has_value() || entry->bound == Bound::UPPER || entry->depth < remaining_depth) {
+                    break;
+                }
+                size_t index = entry->best_child().value_or(NO_CHILD);
+                if constexpr (USES_MOVE_GENERATION) {
+                    auto moves = board.moves();
+                    if (index >= moves.size()) {
+                        break;
+                    }
+                    line.push_back(board.make(moves[index]));
+                }
+                else {
+                    auto children = board.children();
+                    if (index >= children.size()) {
+                        break;
+                    }
+                    line.push_back(std::move(children[index]));
+                }
+            }
+        }
+        return line;
+    }
+
+    [[nodiscard]] static std::vector<Board> root_children(size_t max_depth, const Board& board) {
+        ensure_searchable_depth(max_depth);
+        auto children = board.children();
+        if (children.empty()) {
+            throw std::runtime_error("No moves found");
+        }
+        return children;
+    }
+
+    static void ensure_searchable_depth(size_t max_depth) {
+        if (max_depth == 0) {
+            throw std::runtime_error("No moves found");
+        }
+    }
+
+    // `scores` is only scratch space, sized to the children by the search itself
+    [[nodiscard]] AnalysisResult search_to_depth(
+        size_t max_depth, const Board& board, const std::vector<Board>& children,
+        std::vector<Score>& scores, const AspirationWindow& window
+    ) {
+        scores.resize(children.size());
+        size_t re_searches = 0;
+        auto start_time = std::chrono::steady_clock::now();
+        RootResult root = search_root_widening(max_depth, board, children, scores, window, re_searches);
+        stats.on_iteration_completed(max_depth, std::chrono::steady_clock::now() - start_time);
+        return AnalysisResult {
+            .best_move = children[root.best_move_index],
+            .score = scores[root.best_move_index],
+            .bound = root.bound,
+            .depth = max_depth,
+            .principal_variation = principal_variation_from(children[root.best_move_index], max_depth),
+            .aspiration_re_searches = re_searches
+        };
+    }
+
+    [[nodiscard]] IterativeDeepeningResult search_until(
+        std::chrono::steady_clock::time_point search_deadline, const Board& board, size_t max_depth
+    ) {
+        auto children = root_children(max_depth, board);
+        stats = Stats{};
+        if (auto entry = probe_opening_book(board, children.size(), 1)) {
+            return remember_line(board, result_from_book<IterativeDeepeningResult>(*entry, children));
+        }
+        seed_root_order(board, children);
+        prepare_parallel_search();
+        std::vector<Score> scores;
+        return remember_line(board, with_lazy_helpers(board, children, max_depth, [&] {
+            return deepen_within(search_deadline, board, children, scores, max_depth);
+        }));
+    }
+
+    // iterative deepening loop of `find_best_move_within`, which also reorders `children`
+    // (and `scores`, which is only scratch space, along with them)
+    [[nodiscard]] IterativeDeepeningResult deepen_within(
+        std::chrono::steady_clock::time_point search_deadline, const Board& board,
+        std::vector<Board>& children, std::vector<Score>& scores, size_t max_depth
+    ) {
+        scores.resize(children.size());
+        std::optional<IterativeDeepeningResult> result;
+        size_t re_searches = 0;
+        try {
+            for (size_t depth = 1; depth <= max_depth; depth++) {
+                horizon_reached = false;
+                AspirationWindow window;
+                if (result.has_value() && aspiration_margin > Score{}) {
+                    window = AspirationWindow::around(result->score, aspiration_margin);
+                }
+                auto iteration_start_time = std::chrono::steady_clock::now();
+                size_t best_move_index = search_root_widening(depth, board, children, scores, window, re_searches).best_move_index;
+                stats.on_iteration_completed(depth, std::chrono::steady_clock::now() - iteration_start_time);
+                result = IterativeDeepeningResult { children[best_move_index], depth, scores[best_move_index] };
+                if (!horizon_reached) {
+                    break;
+                }
+                if (std::chrono::steady_clock::now() >= search_deadline) {
+                    result->interrupted = depth < max_depth;
+                    break;
+                }
+                sort_by_scores(board.current_player_is_maximizing(), children, scores);
+                deadline = search_deadline;
+                nodes_before_clock_check = CLOCK_CHECK_INTERVAL;
+            }
+        }
+        catch (const SearchTimeout&) {
+            result->interrupted = true;
+        }
+        catch (const SearchCancelled&) {
+            // without a completed iteration there's nothing to return
+            if (!result.has_value()) {
+                deadline.reset();
+                throw;
+            }
+            result->interrupted = true;
+        }
+        catch (...) {
+            deadline.reset();
+            throw;
+        }
+        deadline.reset();
+        result->aspiration_re_searches = re_searches;
+        result->principal_variation = principal_variation_from(result->best_move, result->completed_depth);
+        return std::move(*result);
+    }
+
+    template <typename Search>
+    [[nodiscard]] auto with_lazy_helpers(
+        const Board& board, const std::vector<Board>& children, size_t max_depth, Search&& search
+    ) {
+        start_lazy_helpers(board, children, max_depth);
+        std::optional<std::invoke_result_t<Search&>> result;
+        try {
+            result.emplace(search());
+        }
+        catch (...) {
+            stop_lazy_helpers();
+            throw;
+        }
+        stop_lazy_helpers();
+        collect_helpers_stats();
+        return std::move(*result);
+    }
+
+    // root of the position a worker is currently searching in a batch, kept by the worker
+    // so that the storage of one position gets reused by the next one
+    struct BatchScratch {
+        std::vector<Board> children;
+        std::vector<Score> scores;
+    };
+
+    BatchScratch batch_scratch;
+
+    // boards that generate moves build the root children straight into the buffer, the
+    // other ones can only hand over the vector `children()` allocated
+    static void expand_root_into(const Board& board, std::vector<Board>& children) {
+        if constexpr (USES_MOVE_GENERATION) {
+            children.clear();
+            auto moves = board.moves();
+            for (size_t index = 0; index < moves.size(); index++) {
+                children.push_back(board.make(moves[index]));
+            }
+        }
+        else {
+            children = board.children();
+        }
+    }
+
+    template <typename Result, typename Search>
+    [[nodiscard]] std::vector<std::optional<Result>> run_batch(std::span<const Board> boards, Search&& search) {
+        stats = Stats{};
+        prepare_batch_analysis();
+        std::vector<std::optional<Result>> results(boards.size());
+        auto search_position = [&](SearchEngine& worker, size_t index) {
+            BatchScratch& scratch = worker.batch_scratch;
+            expand_root_into(boards[index], scratch.children);
+            if (scratch.children.empty()) {
+                return;
+            }
+            results[index].emplace(search(worker, boards[index], scratch));
+        };
+        if (!owned_parallel_context) {
+            for (size_t index = 0; index < boards.size(); index++) {
+                search_position(*this, index);
+            }
+        }
+        else {
+            ParallelContext& context = *owned_parallel_context;
+            TaskGroup positions;
+            for (size_t index = 0; index < boards.size(); index++) {
+                positions.run(context.pool, [&, index] {
+                    search_position(context.engine_of(WorkStealingPool::current_worker()), index);
+                });
+            }
+            positions.wait(context.pool);
+        }
+        collect_helpers_stats();
+        return results;
+    }
+
+    // scores every child of the root (in the given order) and returns the index of the best one;
+    // the best score so far bounds the search of the following children, so only the best child
+    // is guaranteed an exact score. Ties go to the first child for the maximizing player and to
+    // the last one for the minimizing player, hence the latter is bounded by `next_score(best)`
+    // with a narrower `root_window` than the full one, a best score outside of it is only a bound
+    [[nodiscard]] size_t search_root(
+        size_t max_depth, const Board& board, const std::vector<Board>& children,
+        std::vector<Score>& scores, State root_window = State{}
+    ) {
+        iteration_depth = max_depth;
+        synchronize_split_helpers();
+        return (board.current_player_is_maximizing())
+            ? search_root_as<true>(max_depth, children, scores, root_window)
+            : search_root_as<false>(max_depth, children, scores, root_window);
+    }
+
+    // nodes get split even when the root is searched serially, so every iteration hands the
+    // helpers the clock and the depth their plies are measured from, whatever the root does
+    void synchronize_split_helpers() {
+        if (parallel_context == nullptr || parallel_context->owner != this) {
+            return;
+        }
+        for (auto& helper : parallel_context->helpers) {
+            helper->deadline = deadline;
+            helper->nodes_before_clock_check = CLOCK_CHECK_INTERVAL;
+            helper->iteration_depth = iteration_depth;
+        }
+    }
+
+    template <bool Maximizing>
+    [[nodiscard]] size_t search_root_as(
+        size_t max_depth, const std::vector<Board>& children, std::vector<Score>& scores, State root_window
+    ) {
+        if (parallel_context != nullptr && children.size() > 1) {
+            return search_root_in_parallel<Maximizing>(max_depth, children, scores, root_window);
+        }
+        size_t best_move_index = 0;
+        Score best_score_so_far = (Maximizing) ? inf_limit<Score>() : sup_limit<Score>();
+        for (size_t current_move_index = 0; current_move_index < children.size(); current_move_index++) {
+            State window;
+            if constexpr (USES_ALPHA_BETA_PRUNING) {
+                window = (Maximizing)
+                    ? State { std::max(best_score_so_far, root_window.global_maximum), root_window.global_minimum }
+                    : State { root_window.global_maximum, std::min(next_score(best_score_so_far), root_window.global_minimum) };
+            }
+            Score new_score = child_score<Maximizing>(max_depth, children[current_move_index], window, current_move_index == 0);
+            scores[current_move_index] = new_score;
+            if ((new_score > best_score_so_far) == Maximizing) {
+                best_score_so_far = new_score;
+                best_move_index = current_move_index;
+            }
+            // once the best score is past the bound the player is pushing, no other child can
+            // bring it back inside the window: the search fails whatever they're worth
+            if (USES_ALPHA_BETA_PRUNING && window_failure(best_score_so_far, root_window) == failure_of<Maximizing>()) {
+                break;
+            }
+        }
+        return best_move_index;
+    }
+
+    enum class WindowFailure {
+        NONE,
+        LOW,  // the score is only an upper bound
+        HIGH  // the score is only a lower bound
+    };
+
+    [[nodiscard]] static WindowFailure window_failure(Score score, const State& window) {
+        if (score <= window.global_maximum && !score_traits<Score>::equal(window.global_maximum, inf_limit<Score>())) {
+            return WindowFailure::LOW;
+        }
+        if (score >= window.global_minimum && !score_traits<Score>::equal(window.global_minimum, sup_limit<Score>())) {
+            return WindowFailure::HIGH;
+        }
+        return WindowFailure::NONE;
+    }
+
+    template <bool Maximizing>
+    [[nodiscard]] static constexpr WindowFailure failure_of() {
+        return (Maximizing) ? WindowFailure::HIGH : WindowFailure::LOW;
+    }
+
+    struct RootResult {
+        size_t best_move_index = 0;
+        Bound bound = Bound::EXACT;
+    };
+
+    // searches the root through `window`, widening it until the result falls inside (or the
+    // window runs out of re-searches): the search is fail-soft, so even a failed result is
+    // the tightest bound that the search could prove, rather than the bound of the window
+    [[nodiscard]] RootResult search_root_widening(
+        size_t max_depth, const Board& board, const std::vector<Board>& children,
+        std::vector<Score>& scores, AspirationWindow window, size_t& re_searches
+    ) {
+        if constexpr (!USES_ALPHA_BETA_PRUNING) {
+            return RootResult { search_root(max_depth, board, children, scores) };
+        }
+        else {
+            // an empty window can't tell an upper bound from a lower one
+            if (!(window.lower < window.upper)) {
+                window = AspirationWindow {};
+            }
+            Score step = window.widening_step;
+            for (size_t attempt = 0;; attempt++) {
+                State root_window { window.lower, window.upper };
+                size_t best_move_index = search_root(max_depth, board, children, scores, root_window);
+                Score score = scores[best_move_index];
+                WindowFailure failure = window_failure(score, root_window);
+                if (failure == WindowFailure::NONE) {
+                    return RootResult { best_move_index, Bound::EXACT };
+                }
+                if (attempt == window.max_re_searches) {
+                    return RootResult { best_move_index, (failure == WindowFailure::LOW) ? Bound::UPPER : Bound::LOWER };
+                }
+                if (failure == WindowFailure::LOW) {
+                    window.lower = (step > Score{}) ? lower_score_by(score, step) : inf_limit<Score>();
+                }
+                else {
+                    window.upper = (step > Score{}) ? raise_score_by(score, step) : sup_limit<Score>();
+                }
+                step = raise_score_by(step, step);
+                re_searches++;
+            }
+        }
+    }
+
+    // the most promising children according to the last iteration get searched first by the
+    // next one, which makes the bounds they establish prune more of their siblings
+    static void sort_by_scores(bool maximizing, std::vector<Board>& children, std::vector<Score>& scores) {
+        std::vector<size_t> permutation(children.size());
+        std::iota(permutation.begin(), permutation.end(), 0);
+        std::stable_sort(permutation.begin(), permutation.end(), [&](size_t lhs, size_t rhs) {
+            return (maximizing) ? scores[lhs] > scores[rhs] : scores[lhs] < scores[rhs];
+        });
+        std::vector<Board> sorted_children;
+        std::vector<Score> sorted_scores;
+        sorted_children.reserve(children.size());
+        sorted_scores.reserve(scores.size());
+        for (size_t index : permutation) {
+            sorted_children.push_back(std::move(children[index]));
+            sorted_scores.push_back(scores[index]);
+        }
+        children = std::move(sorted_children);
+        scores = std::move(sorted_scores);
+    }
+
+    // interior nodes go through the moves of boards that can generate them, and fall back
+    // to `children()` for the other ones: the former never allocate, the latter do unless
+    // they can build their children into the arena of the current frame
+    [[nodiscard]] auto expand(const Board& board) {
+        if constexpr (USES_MOVE_GENERATION) {
+            return board.moves();
+        }
+        else if constexpr (USES_CHILD_ARENAS) {
+            ArenaResource& arena = arena_of_frame(arena_frame_depth);
+            arena.reset();
+            return board.children(&arena);
+        }
+        else {
+            return board.children();
+        }
+    }
+
+    // frames rather than plies index the arenas, since a worker waiting on a split point can
+    // pick up a task from any depth: the task then stacks its frames on top of the waiting ones
+    std::vector<std::unique_ptr<ArenaResource>> child_arenas;
+    size_t arena_frame_depth = 0;
+
+    struct ArenaFrame {
+        size_t& depth;
+
+        explicit ArenaFrame(size_t& depth) : depth(depth) {
+            depth++;
+        }
+
+        ArenaFrame(const ArenaFrame&) = delete;
+        ArenaFrame& operator=(const ArenaFrame&) = delete;
+
+        ~ArenaFrame() {
+            depth--;
+        }
+    };
+
+    struct NoArenaFrame {};
+
+    [[nodiscard]] auto enter_arena_frame() {
+        if constexpr (USES_CHILD_ARENAS) {
+            return ArenaFrame(arena_frame_depth);
+        }
+        else {
+            return NoArenaFrame{};
+        }
+    }
+
+    [[nodiscard]] ArenaResource& arena_of_frame(size_t frame) {
+        if (frame >= child_arenas.size()) {
+            child_arenas.resize(frame + 1);
+        }
+        auto& arena = child_arenas[frame];
+        if (!arena || arena->upstream_resource() != memory_resource) {
+            arena = std::make_unique<ArenaResource>(memory_resource);
+        }
+        return *arena;
+    }
+
+    [[nodiscard]] static decltype(auto) child_at(const Board& board, const auto& expansion, size_t index) {
+        if constexpr (USES_MOVE_GENERATION) {
+            return board.make(expansion[index]);
+        }
+        else {
+            return expansion[index];
+        }
+    }
+
+    // the best child recorded in the transposition table (if any) is visited first,
+    // the remaining ones keep the order in which `children()` produced them
+    [[nodiscard]] static size_t visiting_order(size_t order, size_t first_child_index, size_t children_count) {
+        if (first_child_index >= children_count || order > first_child_index) {
+            return order;
+        }
+        return (order == 0) ? first_child_index : order - 1;
+    }
+
+    // narrows the window using a previously stored result, returns true when the stored
+    // result alone is enough to answer: in that case the score is left in both bounds
+    [[nodiscard]] bool probe_transposition_table(
+        size_t max_depth, const Board& board, State& state, size_t& first_child_index
+    ) {
+        if constexpr (USES_TRANSPOSITION_TABLE) {
+            auto entry = (shared_transposition_table != nullptr)
+                ? shared_transposition_table->probe(board.hash(), shared_transposition_stats)
+                : transposition_table.probe(board.hash());
+            stats.on_transposition_probe(entry.has_value());
+            if (!entry.has_value()) {
+                return false;
+            }
+            first_child_index = entry->best_child().value_or(NO_CHILD);
+            if (entry->depth < max_depth) {
+                return false;
+            }
+            horizon_reached |= (entry->depth != TranspositionTable<Score>::UNLIMITED_DEPTH);
+            switch (entry->bound) {
+                break; case Bound::EXACT: state.global_maximum = state.global_minimum = entry->score; return true;
+                break; case Bound::LOWER: state.global_maximum = std::max(state.global_maximum, entry->score);
+                break; case Bound::UPPER: state.global_minimum = std::min(state.global_minimum, entry->score);
+            }
+            if (state.global_minimum <= state.global_maximum) {
+                state.global_maximum = state.global_minimum = entry->score;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store_transposition_table(
+        size_t max_depth, const Board& board, const State& initial_state, Score score, size_t best_child_index
+    ) {
+        if constexpr (USES_TRANSPOSITION_TABLE) {
+            Bound bound = Bound::EXACT;
+            if (score <= initial_state.global_maximum) {
+                bound = Bound::UPPER;
+            }
+            else if (score >= initial_state.global_minimum) {
+                bound = Bound::LOWER;
+            }
+            size_t depth = (horizon_reached) ? max_depth : TranspositionTable<Score>::UNLIMITED_DEPTH;
+            if (shared_transposition_table != nullptr) {
+                shared_transposition_table->store(
+                    board.hash(), score, depth, bound, best_child_index, shared_transposition_stats
+                );
+            }
+            else {
+                transposition_table.store(board.hash(), score, depth, bound, best_child_index);
+            }
+        }
+    }
+};
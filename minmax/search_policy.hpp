@@ -0,0 +1,51 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <concepts>
+
+#include "search_stats.hpp"
+
+// Features of the search that are selected at compile time: whatever a policy turns off is
+// not checked at runtime, it's simply not part of the instantiated engine. The transposition
+// table, move ordering, solved positions, batch evaluation and quiescence are further limited
+// to the boards that support them (see `game_board.hpp`), and without cancellation there are
+// neither time budgets nor node splitting between threads.
+template <typename Policy>
+concept search_policy = search_stats_policy<typename Policy::StatsType> && requires {
+    { Policy::ALPHA_BETA_PRUNING } -> std::convertible_to<bool>;
+    { Policy::TRANSPOSITION_TABLE } -> std::convertible_to<bool>;
+    { Policy::MOVE_ORDERING } -> std::convertible_to<bool>;
+    { Policy::CANCELLATION } -> std::convertible_to<bool>;
+    { Policy::SOLVED_POSITIONS } -> std::convertible_to<bool>;
+    { Policy::BATCH_EVALUATION } -> std::convertible_to<bool>;
+    { Policy::QUIESCENCE } -> std::convertible_to<bool>;
+};
+
+template <search_stats_policy Stats = NoSearchStats>
+struct DefaultSearchPolicy {
+    static constexpr bool ALPHA_BETA_PRUNING = true;
+    static constexpr bool TRANSPOSITION_TABLE = true;
+    static constexpr bool MOVE_ORDERING = true;
+    static constexpr bool CANCELLATION = true;
+    static constexpr bool SOLVED_POSITIONS = true;
+    static constexpr bool BATCH_EVALUATION = true;
+    static constexpr bool QUIESCENCE = true;
+    using StatsType = Stats;
+};
+
+// exhaustive minimax, the reference every pruned search must agree with
+template <search_stats_policy Stats = NoSearchStats>
+struct PlainMinimaxPolicy {
+    static constexpr bool ALPHA_BETA_PRUNING = false;
+    static constexpr bool TRANSPOSITION_TABLE = false;
+    static constexpr bool MOVE_ORDERING = false;
+    static constexpr bool CANCELLATION = false;
+    static constexpr bool SOLVED_POSITIONS = false;
+    static constexpr bool BATCH_EVALUATION = false;
+    static constexpr bool QUIESCENCE = false;
+    using StatsType = Stats;
+};
@@ -0,0 +1,174 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+#include <chrono>
+#include <concepts>
+#include <vector>
+#include <ostream>
+#include <algorithm>
+
+// Statistics are a compile-time policy of the engine: every hook is invoked unconditionally,
+// and with `NoSearchStats` (the default) they are all empty and get optimized away.
+template <typename Stats>
+concept search_stats_policy = std::default_initializable<Stats> && requires (
+    Stats& stats, const Stats& other, size_t value, bool flag, std::chrono::steady_clock::duration elapsed
+) {
+    stats.on_node(value);
+    stats.on_leaf();
+    stats.on_null_window_search();
+    stats.on_re_search();
+    stats.on_transposition_probe(flag);
+    stats.on_cutoff(value);
+    stats.on_iteration_completed(value, elapsed);
+    stats.merge(other);
+};
+
+struct NoSearchStats {
+    void on_node(size_t) {}
+    void on_leaf() {}
+    void on_null_window_search() {}
+    void on_re_search() {}
+    void on_transposition_probe(bool) {}
+    void on_cutoff(size_t) {}
+    void on_iteration_completed(size_t, std::chrono::steady_clock::duration) {}
+    void merge(const NoSearchStats&) {}
+};
+
+struct SearchStats {
+
+    struct Iteration {
+        size_t depth = 0;
+        size_t nodes_visited = 0;
+        double milliseconds = 0;
+    };
+
+    size_t nodes_visited = 0;
+    size_t leaf_evaluations = 0;
+    size_t null_window_searches = 0;
+    size_t re_searches = 0;
+    size_t transposition_probes = 0;
+    size_t transposition_hits = 0;
+    size_t max_depth_reached = 0;
+
+    // cutoffs_by_child_index[i] counts the cutoffs caused by the i-th visited child of a node:
+    // the closer they are to the first one, the better the move ordering
+    std::vector<size_t> cutoffs_by_child_index;
+
+    // completed iterations of the root search (a single one for fixed depth searches),
+    // node counts are the ones of the thread that ran the root
+    std::vector<Iteration> iterations;
+
+    void on_node(size_t ply) {
+        nodes_visited++;
+        max_depth_reached = std::max(max_depth_reached, ply);
+    }
+
+    void on_leaf() {
+        leaf_evaluations++;
+    }
+
+    void on_null_window_search() {
+        null_window_searches++;
+    }
+
+    void on_re_search() {
+        re_searches++;
+    }
+
+    void on_transposition_probe(bool hit) {
+        transposition_probes++;
+        transposition_hits += hit;
+    }
+
+    void on_cutoff(size_t child_order) {
+        if (child_order >= cutoffs_by_child_index.size()) {
+            cutoffs_by_child_index.resize(child_order + 1, 0);
+        }
+        cutoffs_by_child_index[child_order]++;
+    }
+
+    void on_iteration_completed(size_t depth, std::chrono::steady_clock::duration elapsed) {
+        size_t nodes_so_far = 0;
+        for (const Iteration& iteration : iterations) {
+            nodes_so_far += iteration.nodes_visited;
+        }
+        iterations.push_back(Iteration {
+            .depth = depth,
+            .nodes_visited = nodes_visited - nodes_so_far,
+            .milliseconds = std::chrono::duration<double, std::milli>(elapsed).count()
+        });
+    }
+
+    void merge(const SearchStats& other) {
+        nodes_visited += other.nodes_visited;
+        leaf_evaluations += other.leaf_evaluations;
+        null_window_searches += other.null_window_searches;
+        re_searches += other.re_searches;
+        transposition_probes += other.transposition_probes;
+        transposition_hits += other.transposition_hits;
+        max_depth_reached = std::max(max_depth_reached, other.max_depth_reached);
+        if (other.cutoffs_by_child_index.size() > cutoffs_by_child_index.size()) {
+            cutoffs_by_child_index.resize(other.cutoffs_by_child_index.size(), 0);
+        }
+        for (size_t index = 0; index < other.cutoffs_by_child_index.size(); index++) {
+            cutoffs_by_child_index[index] += other.cutoffs_by_child_index[index];
+        }
+    }
+
+    [[nodiscard]] size_t total_cutoffs() const {
+        size_t total = 0;
+        for (size_t cutoffs : cutoffs_by_child_index) {
+            total += cutoffs;
+        }
+        return total;
+    }
+
+    void write_json(std::ostream& stream) const {
+        stream << "{"
+               << "\"nodes_visited\":" << nodes_visited << ","
+               << "\"leaf_evaluations\":" << leaf_evaluations << ","
+               << "\"null_window_searches\":" << null_window_searches << ","
+               << "\"re_searches\":" << re_searches << ","
+               << "\"transposition_probes\":" << transposition_probes << ","
+               << "\"transposition_hits\":" << transposition_hits << ","
+               << "\"max_depth_reached\":" << max_depth_reached << ","
+               << "\"cutoffs_by_child_index\":[";
+        for (size_t index = 0; index < cutoffs_by_child_index.size(); index++) {
+            stream << ((index == 0) ? "" : ",") << cutoffs_by_child_index[index];
+        }
+        stream << "],\"iterations\":[";
+        for (size_t index = 0; index < iterations.size(); index++) {
+            const Iteration& iteration = iterations[index];
+            stream << ((index == 0) ? "" : ",")
+                   << "{\"depth\":" << iteration.depth
+                   << ",\"nodes_visited\":" << iteration.nodes_visited
+                   << ",\"milliseconds\":" << iteration.milliseconds << "}";
+        }
+        stream << "]}";
+    }
+
+    // long format (one `metric,key,value` row per figure), so that every
+    // search produces the same columns whatever its depth and branching factor
+    void write_csv(std::ostream& stream) const {
+        stream << "metric,key,value\n"
+               << "nodes_visited,," << nodes_visited << "\n"
+               << "leaf_evaluations,," << leaf_evaluations << "\n"
+               << "null_window_searches,," << null_window_searches << "\n"
+               << "re_searches,," << re_searches << "\n"
+               << "transposition_probes,," << transposition_probes << "\n"
+               << "transposition_hits,," << transposition_hits << "\n"
+               << "max_depth_reached,," << max_depth_reached << "\n";
+        for (size_t index = 0; index < cutoffs_by_child_index.size(); index++) {
+            stream << "cutoffs_by_child_index," << index << "," << cutoffs_by_child_index[index] << "\n";
+        }
+        for (const Iteration& iteration : iterations) {
+            stream << "iteration_nodes_visited," << iteration.depth << "," << iteration.nodes_visited << "\n"
+                   << "iteration_milliseconds," << iteration.depth << "," << iteration.milliseconds << "\n";
+        }
+    }
+};
@@ -0,0 +1,177 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#include "game_score.hpp"
+#include "search_stats.hpp"
+
+// A node of the search tree, recorded once it has been searched: records come out in
+// post-order (children before their parent), so the subtree of a node is made of the records
+// right before it whose ply is higher than its own. That only holds for single-threaded
+// searches, with more threads the records of the helpers are appended to the main thread's
+template <game_score Score>
+struct SearchTraceRecord {
+    static constexpr uint8_t NO_CUTOFF = UINT8_MAX;
+
+    // zero for boards that can't be hashed
+    uint64_t hash = 0;
+    Score alpha{};
+    Score beta{};
+    Score score{};
+    uint16_t ply = 0;
+
+    // plies left to the horizon (zero for leaves, as well as for nodes searched past it)
+    uint16_t depth = 0;
+
+    // visiting order of the child that caused a cutoff, if any did
+    uint8_t cutoff_order = NO_CUTOFF;
+};
+
+// records are padded up to the alignment of the hash, the padding being written as zeros
+static_assert(sizeof(SearchTraceRecord<int>) == 32 && sizeof(SearchTraceRecord<double>) == 40);
+
+// stats policies that also want the nodes themselves, on top of the usual counters
+template <typename Stats, typename Score>
+concept search_trace_policy = search_stats_policy<Stats> && requires (Stats& stats, const SearchTraceRecord<Score>& record) {
+    stats.on_node_searched(record);
+};
+
+// `SearchStats` plus the records of the nodes of the last search, for offline analysis (see
+// `tools/search_trace_report.cpp`): once `MaxRecords` have been recorded, any further node
+// is only counted, so that the memory taken by a long search stays bounded
+template <game_score Score, size_t MaxRecords = size_t(1) << 20>
+struct SearchTracer : SearchStats {
+
+    using Record = SearchTraceRecord<Score>;
+
+    static constexpr size_t MAX_RECORDS = MaxRecords;
+
+    std::vector<Record> records;
+    size_t dropped_records = 0;
+
+    void on_node_searched(const Record& record) {
+        if (records.size() < MAX_RECORDS) {
+            // fields are copied one by one into zeroed storage: copying the whole record would
+            // carry its indeterminate padding over, and into the trace files with it
+            Record& stored = records.emplace_back();
+            std::memset(static_cast<void*>(&stored), 0, sizeof(stored));
+            stored.hash = record.hash;
+            stored.alpha = record.alpha;
+            stored.beta = record.beta;
+            stored.score = record.score;
+            stored.ply = record.ply;
+            stored.depth = record.depth;
+            stored.cutoff_order = record.cutoff_order;
+        }
+        else {
+            dropped_records++;
+        }
+    }
+
+    void merge(const SearchTracer& other) {
+        SearchStats::merge(other);
+        size_t kept = std::min(other.records.size(), MAX_RECORDS - records.size());
+        records.insert(records.end(), other.records.begin(), other.records.begin() + kept);
+        dropped_records += other.dropped_records + (other.records.size() - kept);
+    }
+};
+
+// File layout: a fixed header followed by the records, both stored exactly as they are laid
+// out in memory (hence in native byte order, which the magic number detects)
+struct SearchTraceHeader {
+    static constexpr uint64_t MAGIC = 0x45435254584d4e4dULL; // "MNMXTRCE" in little endian
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t magic = MAGIC;
+    uint32_t version = VERSION;
+    uint32_t record_size = 0;
+    uint32_t score_size = 0;
+    uint32_t score_is_floating_point = 0;
+    uint64_t record_count = 0;
+    uint64_t dropped_records = 0;
+};
+
+// no padding, so the header can be written as it is laid out in memory
+static_assert(sizeof(SearchTraceHeader) == 40 && std::has_unique_object_representations_v<SearchTraceHeader>);
+
+template <game_score Score>
+[[nodiscard]] SearchTraceHeader search_trace_header_for(size_t record_count, size_t dropped_records) {
+    SearchTraceHeader header;
+    header.record_size = sizeof(SearchTraceRecord<Score>);
+    header.score_size = sizeof(Score);
+    header.score_is_floating_point = std::is_floating_point_v<Score>;
+    header.record_count = record_count;
+    header.dropped_records = dropped_records;
+    return header;
+}
+
+template <game_score Score, size_t MaxRecords>
+void write_search_trace(const std::string& path, const SearchTracer<Score, MaxRecords>& tracer) {
+    static_assert(std::is_trivially_copyable_v<SearchTraceRecord<Score>>);
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        throw std::runtime_error("Error: cannot write search trace " + path);
+    }
+    SearchTraceHeader header = search_trace_header_for<Score>(tracer.records.size(), tracer.dropped_records);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(tracer.records.data()), tracer.records.size() * sizeof(SearchTraceRecord<Score>));
+    if (!file) {
+        throw std::runtime_error("Error: cannot write search trace " + path);
+    }
+}
+
+// the header alone, to find out which score type the records were written with
+[[nodiscard]] inline SearchTraceHeader read_search_trace_header(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Error: cannot open search trace " + path);
+    }
+    SearchTraceHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != SearchTraceHeader::MAGIC || header.version != SearchTraceHeader::VERSION) {
+        throw std::runtime_error("Error: malformed search trace " + path);
+    }
+    return header;
+}
+
+template <game_score Score>
+struct SearchTrace {
+    std::vector<SearchTraceRecord<Score>> records;
+    size_t dropped_records = 0;
+};
+
+template <game_score Score>
+[[nodiscard]] SearchTrace<Score> read_search_trace(const std::string& path) {
+    SearchTraceHeader header = read_search_trace_header(path);
+    SearchTraceHeader expected = search_trace_header_for<Score>(header.record_count, header.dropped_records);
+    if (header.record_size != expected.record_size || header.score_size != expected.score_size
+        || header.score_is_floating_point != expected.score_is_floating_point) {
+        throw std::runtime_error("Error: incompatible search trace " + path);
+    }
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (static_cast<uint64_t>(file.tellg()) != sizeof(header) + header.record_count * sizeof(SearchTraceRecord<Score>)) {
+        throw std::runtime_error("Error: truncated search trace " + path);
+    }
+    file.seekg(sizeof(header));
+    SearchTrace<Score> trace;
+    trace.records.resize(header.record_count);
+    trace.dropped_records = header.dropped_records;
+    file.read(reinterpret_cast<char*>(trace.records.data()), header.record_count * sizeof(SearchTraceRecord<Score>));
+    if (!file) {
+        throw std::runtime_error("Error: truncated search trace " + path);
+    }
+    return trace;
+}
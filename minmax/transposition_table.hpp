@@ -0,0 +1,297 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+#include <bit>
+#include <optional>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cstring>
+#include <type_traits>
+
+#include "game_score.hpp"
+
+enum class Bound : uint8_t {
+    EXACT,
+    LOWER,
+    UPPER
+};
+
+struct TranspositionStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t overwrites = 0;
+};
+
+template <game_score Score>
+struct TranspositionEntry {
+
+    // stored in place of a best child whose index does not fit in the entry: boards with
+    // that many children get no hint from the table rather than a hint to the wrong child
+    static constexpr uint8_t NO_BEST_CHILD = UINT8_MAX;
+
+    uint64_t key = 0;
+    Score score{};
+    uint16_t depth = 0;
+    Bound bound = Bound::EXACT;
+    uint8_t best_child_index = NO_BEST_CHILD;
+    bool occupied = false;
+
+    [[nodiscard]] static uint8_t encode_best_child(size_t index) {
+        return (index < NO_BEST_CHILD) ? static_cast<uint8_t>(index) : NO_BEST_CHILD;
+    }
+
+    [[nodiscard]] std::optional<size_t> best_child() const {
+        if (best_child_index == NO_BEST_CHILD) {
+            return std::nullopt;
+        }
+        return best_child_index;
+    }
+};
+
+// keys are not required to be uniformly distributed (a board might as well
+// use an exact positional encoding), so they get mixed before indexing
+[[nodiscard]] inline uint64_t mix_transposition_key(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    return key;
+}
+
+template <game_score Score>
+class TranspositionTable {
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    static constexpr size_t ENTRIES_PER_BUCKET =
+        std::max<size_t>(1, CACHE_LINE_SIZE / sizeof(TranspositionEntry<Score>));
+
+    struct alignas(CACHE_LINE_SIZE) Bucket {
+        std::array<TranspositionEntry<Score>, ENTRIES_PER_BUCKET> entries{};
+    };
+
+    std::vector<Bucket> buckets;
+    TranspositionStats statistics;
+
+    [[nodiscard]] Bucket& bucket_of(uint64_t key) {
+        return buckets[mix_transposition_key(key) & (buckets.size() - 1)];
+    }
+
+public:
+
+    static constexpr size_t DEFAULT_CAPACITY = size_t(1) << 20;
+
+    // results that did not depend on the search horizon hold regardless of the depth
+    static constexpr size_t UNLIMITED_DEPTH = UINT16_MAX;
+
+    explicit TranspositionTable(size_t capacity = DEFAULT_CAPACITY)
+        : buckets(std::bit_ceil(std::max<size_t>(1, capacity / ENTRIES_PER_BUCKET)))
+    {}
+
+    [[nodiscard]] std::optional<TranspositionEntry<Score>> probe(uint64_t key) {
+        for (const auto& entry : bucket_of(key).entries) {
+            if (entry.occupied && entry.key == key) {
+                statistics.hits++;
+                return entry;
+            }
+        }
+        statistics.misses++;
+        return std::nullopt;
+    }
+
+    // same lookup as `probe`, without counting it
+    [[nodiscard]] std::optional<TranspositionEntry<Score>> peek(uint64_t key) const {
+        for (const auto& entry : buckets[mix_transposition_key(key) & (buckets.size() - 1)].entries) {
+            if (entry.occupied && entry.key == key) {
+                return entry;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void store(uint64_t key, Score score, size_t depth, Bound bound, size_t best_child_index) {
+        auto& entries = bucket_of(key).entries;
+        auto* victim = &entries[0];
+        for (auto& entry : entries) {
+            if (!entry.occupied || entry.key == key) {
+                victim = &entry;
+                break;
+            }
+            if (entry.depth < victim->depth) {
+                victim = &entry;
+            }
+        }
+        if (victim->occupied && victim->key != key) {
+            statistics.overwrites++;
+        }
+        *victim = TranspositionEntry<Score> {
+            .key = key,
+            .score = score,
+            .depth = static_cast<uint16_t>(std::min<size_t>(depth, UINT16_MAX)),
+            .bound = bound,
+            .best_child_index = TranspositionEntry<Score>::encode_best_child(best_child_index),
+            .occupied = true
+        };
+    }
+
+    void clear() {
+        std::fill(buckets.begin(), buckets.end(), Bucket{});
+        statistics = TranspositionStats{};
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return buckets.size() * ENTRIES_PER_BUCKET;
+    }
+
+    [[nodiscard]] const TranspositionStats& stats() const {
+        return statistics;
+    }
+};
+
+// Lock-free variant of `TranspositionTable` meant to be shared by several searching threads.
+// Every entry is made of three independent atomic words, the first of which holds the key
+// xor-ed with the other two: an entry torn by concurrent writes fails the check and is
+// treated as a miss. Races can at worst lose an entry, never hand out a corrupted one.
+// Counters are kept by the callers, to avoid having every thread write to the same line.
+template <game_score Score>
+class SharedTranspositionTable {
+
+    static_assert(sizeof(Score) <= sizeof(uint64_t) && std::is_trivially_copyable_v<Score>);
+
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct Slot {
+        std::atomic<uint64_t> check = 0;
+        std::atomic<uint64_t> score_bits = 0;
+        std::atomic<uint64_t> metadata = 0;
+    };
+
+    static constexpr size_t ENTRIES_PER_BUCKET = std::max<size_t>(1, CACHE_LINE_SIZE / sizeof(Slot));
+
+    struct alignas(CACHE_LINE_SIZE) Bucket {
+        std::array<Slot, ENTRIES_PER_BUCKET> slots;
+    };
+
+    static constexpr uint64_t OCCUPIED_FLAG = uint64_t(1) << 32;
+
+    size_t bucket_count;
+    std::unique_ptr<Bucket[]> buckets;
+
+    [[nodiscard]] Bucket& bucket_of(uint64_t key) {
+        return buckets[mix_transposition_key(key) & (bucket_count - 1)];
+    }
+
+    [[nodiscard]] static uint64_t encode_score(Score score) {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &score, sizeof(Score));
+        return bits;
+    }
+
+    [[nodiscard]] static Score decode_score(uint64_t bits) {
+        Score score;
+        std::memcpy(&score, &bits, sizeof(Score));
+        return score;
+    }
+
+    [[nodiscard]] static std::optional<TranspositionEntry<Score>> load(const Slot& slot) {
+        uint64_t check = slot.check.load(std::memory_order_relaxed);
+        uint64_t score_bits = slot.score_bits.load(std::memory_order_relaxed);
+        uint64_t metadata = slot.metadata.load(std::memory_order_relaxed);
+        if (!(metadata & OCCUPIED_FLAG)) {
+            return std::nullopt;
+        }
+        return TranspositionEntry<Score> {
+            .key = check ^ score_bits ^ metadata,
+            .score = decode_score(score_bits),
+            .depth = static_cast<uint16_t>(metadata & 0xFFFF),
+            .bound = static_cast<Bound>((metadata >> 16) & 0xFF),
+            .best_child_index = static_cast<uint8_t>((metadata >> 24) & 0xFF),
+            .occupied = true
+        };
+    }
+
+public:
+
+    static constexpr size_t DEFAULT_CAPACITY = TranspositionTable<Score>::DEFAULT_CAPACITY;
+    static constexpr size_t UNLIMITED_DEPTH = TranspositionTable<Score>::UNLIMITED_DEPTH;
+
+    explicit SharedTranspositionTable(size_t capacity = DEFAULT_CAPACITY)
+        : bucket_count(std::bit_ceil(std::max<size_t>(1, capacity / ENTRIES_PER_BUCKET)))
+        , buckets(std::make_unique<Bucket[]>(bucket_count))
+    {}
+
+    [[nodiscard]] std::optional<TranspositionEntry<Score>> probe(uint64_t key, TranspositionStats& statistics) {
+        for (const Slot& slot : bucket_of(key).slots) {
+            auto entry = load(slot);
+            if (entry.has_value() && entry->key == key) {
+                statistics.hits++;
+                return entry;
+            }
+        }
+        statistics.misses++;
+        return std::nullopt;
+    }
+
+    [[nodiscard]] std::optional<TranspositionEntry<Score>> peek(uint64_t key) const {
+        for (const Slot& slot : buckets[mix_transposition_key(key) & (bucket_count - 1)].slots) {
+            auto entry = load(slot);
+            if (entry.has_value() && entry->key == key) {
+                return entry;
+            }
+        }
+        return std::nullopt;
+    }
+
+    void store(
+        uint64_t key, Score score, size_t depth, Bound bound, size_t best_child_index, TranspositionStats& statistics
+    ) {
+        auto& slots = bucket_of(key).slots;
+        Slot* victim = &slots[0];
+        std::optional<TranspositionEntry<Score>> victim_entry = load(slots[0]);
+        for (Slot& slot : slots) {
+            auto entry = load(slot);
+            if (!entry.has_value() || entry->key == key) {
+                victim = &slot;
+                victim_entry = entry;
+                break;
+            }
+            if (victim_entry.has_value() && entry->depth < victim_entry->depth) {
+                victim = &slot;
+                victim_entry = entry;
+            }
+        }
+        if (victim_entry.has_value() && victim_entry->key != key) {
+            statistics.overwrites++;
+        }
+        uint64_t score_bits = encode_score(score);
+        uint64_t metadata = std::min<uint64_t>(depth, UINT16_MAX)
+            | (uint64_t(bound) << 16)
+            | (uint64_t(TranspositionEntry<Score>::encode_best_child(best_child_index)) << 24)
+            | OCCUPIED_FLAG;
+        victim->check.store(key ^ score_bits ^ metadata, std::memory_order_relaxed);
+        victim->score_bits.store(score_bits, std::memory_order_relaxed);
+        victim->metadata.store(metadata, std::memory_order_relaxed);
+    }
+
+    void clear() {
+        for (size_t index = 0; index < bucket_count; index++) {
+            for (Slot& slot : buckets[index].slots) {
+                slot.metadata.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return bucket_count * ENTRIES_PER_BUCKET;
+    }
+};
+
+struct NoTranspositionTable {};
@@ -0,0 +1,173 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <optional>
+
+// Pool of `size` participants: `size - 1` background threads plus the thread that submits
+// the work, which is expected to help (see `TaskGroup::wait`) instead of blocking. Every
+// participant owns a queue, pops its own tasks from the back and steals from the front of
+// the others' queues when it runs out of work.
+class WorkStealingPool {
+
+    using Task = std::function<void()>;
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::jthread> threads;
+    std::atomic<size_t> queued_tasks = 0;
+    std::mutex sleep_mutex;
+    std::condition_variable wake_up;
+    bool stopping = false;
+
+    static inline thread_local size_t worker_index = 0;
+
+    [[nodiscard]] std::optional<Task> pop_task() {
+        size_t own = worker_index;
+        for (size_t offset = 0; offset < queues.size(); offset++) {
+            Queue& queue = *queues[(own + offset) % queues.size()];
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty()) {
+                continue;
+            }
+            Task task;
+            if (offset == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            queued_tasks--;
+            return task;
+        }
+        return std::nullopt;
+    }
+
+    void worker_loop(size_t index) {
+        worker_index = index;
+        while (true) {
+            if (run_pending_task()) {
+                continue;
+            }
+            std::unique_lock lock(sleep_mutex);
+            wake_up.wait(lock, [this] { return stopping || queued_tasks > 0; });
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+public:
+
+    explicit WorkStealingPool(size_t size) {
+        for (size_t index = 0; index < std::max<size_t>(size, 1); index++) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (size_t index = 1; index < queues.size(); index++) {
+            threads.emplace_back([this, index] { worker_loop(index); });
+        }
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard lock(sleep_mutex);
+            stopping = true;
+        }
+        wake_up.notify_all();
+        threads.clear();
+    }
+
+    [[nodiscard]] size_t size() const {
+        return queues.size();
+    }
+
+    // index of the calling participant: background threads go from 1 to `size() - 1`,
+    // whichever other thread uses the pool is considered to be participant 0
+    [[nodiscard]] static size_t current_worker() {
+        return worker_index;
+    }
+
+    void submit(Task task) {
+        {
+            Queue& queue = *queues[worker_index];
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+            queued_tasks++;
+        }
+        std::lock_guard lock(sleep_mutex);
+        wake_up.notify_one();
+    }
+
+    bool run_pending_task() {
+        auto task = pop_task();
+        if (!task.has_value()) {
+            return false;
+        }
+        (*task)();
+        return true;
+    }
+};
+
+// Set of tasks whose completion can be awaited: the first exception thrown by any
+// of them is rethrown by `wait`, which only returns once every task has finished
+class TaskGroup {
+
+    std::atomic<size_t> pending_tasks = 0;
+    std::mutex failure_mutex;
+    std::exception_ptr failure;
+
+public:
+
+    template <typename Function>
+    void run(WorkStealingPool& pool, Function&& function) {
+        pending_tasks++;
+        pool.submit([this, function = std::forward<Function>(function)] {
+            try {
+                function();
+            }
+            catch (...) {
+                std::lock_guard lock(failure_mutex);
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+            pending_tasks--;
+        });
+    }
+
+    // the waiting thread keeps running pending tasks (possibly from other groups)
+    // so that no participant ever sits idle while there is work to do
+    void wait(WorkStealingPool& pool) {
+        while (pending_tasks > 0) {
+            if (!pool.run_pending_task()) {
+                std::this_thread::yield();
+            }
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+};
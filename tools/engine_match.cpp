@@ -0,0 +1,135 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+#include "connect4.hpp"
+#include "mcts_engine.hpp"
+
+// Plays Connect4 games between `Connect4Engine` (iterative deepening alpha-beta) and
+// `MctsEngine`, both given the same `--ms` per move and `--threads` workers. Each opening
+// is played twice with colors swapped; the first `--opening` plies are taken from a fixed
+// sequence of openings, so that the games don't all repeat the same line.
+
+struct MatchOptions {
+    size_t games = 10;
+    size_t milliseconds = 100;
+    size_t opening_plies = 2;
+    size_t thread_count = 1;
+    SelectionPolicy selection_policy = SelectionPolicy::UCT;
+};
+
+struct MatchTally {
+    size_t alpha_beta_wins = 0;
+    size_t mcts_wins = 0;
+    size_t draws = 0;
+    size_t alpha_beta_moves = 0;
+    size_t alpha_beta_depth = 0;
+    size_t mcts_moves = 0;
+    size_t mcts_iterations = 0;
+};
+
+[[nodiscard]] static MatchOptions parse_options(int argc, char** argv) {
+    MatchOptions options;
+    for (int index = 1; index < argc; index++) {
+        std::string argument = argv[index];
+        bool has_value = index + 1 < argc;
+        if (argument == "--games" && has_value) {
+            options.games = std::max<size_t>(std::stoul(argv[++index]), 1);
+        }
+        else if (argument == "--ms" && has_value) {
+            options.milliseconds = std::max<size_t>(std::stoul(argv[++index]), 1);
+        }
+        else if (argument == "--opening" && has_value) {
+            options.opening_plies = std::stoul(argv[++index]);
+        }
+        else if (argument == "--threads" && has_value) {
+            options.thread_count = std::max<size_t>(std::stoul(argv[++index]), 1);
+        }
+        else if (argument == "--puct") {
+            options.selection_policy = SelectionPolicy::PUCT;
+        }
+        else {
+            throw std::runtime_error(
+                "usage: engine_match [--games <n>] [--ms <n>] [--opening <plies>] [--threads <n>] [--puct]"
+            );
+        }
+    }
+    return options;
+}
+
+// the n-th opening, read as a number in base COLUMNS with one digit per ply
+[[nodiscard]] static Connect4BitBoard play_opening(size_t opening, size_t plies) {
+    Connect4BitBoard board;
+    for (size_t ply = 0; ply < plies && !board.moves().empty(); ply++) {
+        auto moves = board.moves();
+        board = board.make(moves[opening % moves.size()]);
+        opening /= Connect4BitBoard::COLUMNS;
+    }
+    return board;
+}
+
+static void play_game(size_t game, const MatchOptions& options, MatchTally& tally) {
+    auto budget = std::chrono::milliseconds(options.milliseconds);
+    bool alpha_beta_is_x = game % 2 == 0;
+    Connect4BitBoard board = play_opening(game / 2, options.opening_plies);
+    Connect4Engine alpha_beta;
+    alpha_beta.thread_count = options.thread_count;
+    MctsEngine<Connect4BitBoard> mcts;
+    mcts.thread_count = options.thread_count;
+    mcts.selection_policy = options.selection_policy;
+    while (!board.moves().empty()) {
+        if (board.current_player_is_maximizing() == alpha_beta_is_x) {
+            auto result = alpha_beta.find_best_move_within(budget, board);
+            board = result.best_move;
+            tally.alpha_beta_moves++;
+            tally.alpha_beta_depth += result.completed_depth;
+        }
+        else {
+            auto result = mcts.analyze_within(budget, board);
+            board = result.best_move;
+            tally.mcts_moves++;
+            tally.mcts_iterations += result.iterations;
+        }
+    }
+    auto outcome = board.outcome();
+    bool alpha_beta_won = (outcome == GameOutcome::MAXIMIZING_PLAYER_WINS) == alpha_beta_is_x;
+    if (outcome == GameOutcome::DRAW || !outcome.has_value()) {
+        tally.draws++;
+    }
+    else if (alpha_beta_won) {
+        tally.alpha_beta_wins++;
+    }
+    else {
+        tally.mcts_wins++;
+    }
+    std::cout << "game " << game + 1 << ": alpha-beta as " << (alpha_beta_is_x ? "X" : "O") << ", "
+              << ((outcome == GameOutcome::DRAW || !outcome.has_value()) ? "draw" : alpha_beta_won ? "alpha-beta wins" : "mcts wins")
+              << std::endl;
+}
+
+int main(int argc, char** argv) {
+    try {
+        MatchOptions options = parse_options(argc, argv);
+        MatchTally tally;
+        for (size_t game = 0; game < options.games; game++) {
+            play_game(game, options, tally);
+        }
+        std::cout << "alpha-beta " << tally.alpha_beta_wins << ", mcts " << tally.mcts_wins
+                  << ", draws " << tally.draws << std::endl;
+        std::cout << "alpha-beta reached depth " << tally.alpha_beta_depth / std::max<size_t>(tally.alpha_beta_moves, 1)
+                  << " per move on average, mcts ran " << tally.mcts_iterations / std::max<size_t>(tally.mcts_moves, 1)
+                  << " iterations per move" << std::endl;
+        return 0;
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 2;
+    }
+}
@@ -0,0 +1,113 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+#include "connect4.hpp"
+#include "opening_book.hpp"
+
+// Searches every Connect4 position reachable within `--plies` moves from the empty board
+// at a fixed `--depth`, and writes the results to an opening book that `Connect4Engine`
+// can then answer those positions from (see `OpeningBook`). The engine is cleared before
+// every position, so that the book holds exactly what a search at that depth would find;
+// `--threads` workers take part in each of these searches.
+
+struct BuilderOptions {
+    std::string output_path = "connect4.book";
+    size_t plies = 4;
+    size_t depth = 12;
+    size_t thread_count = 1;
+};
+
+[[nodiscard]] static BuilderOptions parse_options(int argc, char** argv) {
+    BuilderOptions options;
+    for (int index = 1; index < argc; index++) {
+        std::string argument = argv[index];
+        bool has_value = index + 1 < argc;
+        if (argument == "--output" && has_value) {
+            options.output_path = argv[++index];
+        }
+        else if (argument == "--plies" && has_value) {
+            options.plies = std::stoul(argv[++index]);
+        }
+        else if (argument == "--depth" && has_value) {
+            options.depth = std::max<size_t>(std::stoul(argv[++index]), 1);
+        }
+        else if (argument == "--threads" && has_value) {
+            options.thread_count = std::max<size_t>(std::stoul(argv[++index]), 1);
+        }
+        else {
+            throw std::runtime_error(
+                "usage: opening_book_builder [--output <file>] [--plies <n>] [--depth <n>] [--threads <n>]"
+            );
+        }
+    }
+    return options;
+}
+
+// positions reached through different move orders get searched only once
+static void collect_positions(
+    const Connect4BitBoard& board, size_t plies_left,
+    std::unordered_set<uint64_t>& visited, std::vector<Connect4BitBoard>& positions
+) {
+    if (board.moves().empty() || !visited.insert(board.hash()).second) {
+        return;
+    }
+    positions.push_back(board);
+    if (plies_left == 0) {
+        return;
+    }
+    for (const Connect4BitBoard& child : board.children()) {
+        collect_positions(child, plies_left - 1, visited, positions);
+    }
+}
+
+[[nodiscard]] static size_t child_index_of(const Connect4BitBoard& board, const Connect4BitBoard& child) {
+    auto children = board.children();
+    auto found = std::find_if(children.begin(), children.end(), [&](const Connect4BitBoard& candidate) {
+        return candidate.hash() == child.hash();
+    });
+    return static_cast<size_t>(found - children.begin());
+}
+
+int main(int argc, char** argv) {
+    try {
+        BuilderOptions options = parse_options(argc, argv);
+        std::unordered_set<uint64_t> visited;
+        std::vector<Connect4BitBoard> positions;
+        collect_positions(Connect4BitBoard(), options.plies, visited, positions);
+        std::cout << "searching " << positions.size() << " positions at depth " << options.depth << std::endl;
+
+        std::vector<OpeningBookEntry<Connect4BitBoard::score_t>> entries;
+        entries.reserve(positions.size());
+        auto start_time = std::chrono::steady_clock::now();
+        Connect4Engine engine;
+        engine.thread_count = options.thread_count;
+        for (const Connect4BitBoard& position : positions) {
+            engine.clear();
+            auto result = engine.analyze(options.depth, position);
+            entries.push_back(OpeningBookEntry<Connect4BitBoard::score_t> {
+                .key = position.hash(),
+                .score = result.score,
+                .depth = static_cast<uint16_t>(options.depth),
+                .best_child_index = static_cast<uint8_t>(child_index_of(position, result.best_move))
+            });
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+        write_opening_book(options.output_path, std::move(entries));
+        std::cout << "wrote " << options.output_path << " in " << seconds << " s" << std::endl;
+        return 0;
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 2;
+    }
+}
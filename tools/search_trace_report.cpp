@@ -0,0 +1,250 @@
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+// AUTHOR: Francesco De Rosa (https://github.com/fDero)                    //
+// LICENSE: MIT (https://opensource.org/license/mit)                       //
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~//
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+
+#include "search_trace.hpp"
+
+// Reads a search trace (written through a `SearchTracer`, e.g. by `minmax_bench --trace`) and
+// reports, ply by ply, how many nodes were searched, the effective branching factor and how
+// often the first child was enough for a cutoff, followed by the largest subtrees. Given a
+// second trace as `--baseline`, both get reported side by side, along with the positions whose
+// subtrees grew (or shrank) the most from one to the other.
+
+struct ReportOptions {
+    std::string trace_path;
+    std::string baseline_path;
+    size_t top = 10;
+};
+
+struct PlySummary {
+    size_t nodes = 0;
+    size_t interior_nodes = 0;
+    size_t cutoffs = 0;
+    size_t first_child_cutoffs = 0;
+};
+
+template <game_score Score>
+struct TraceAnalysis {
+    SearchTrace<Score> trace;
+
+    // nodes in the subtree of each record, the record itself included
+    std::vector<size_t> subtree_nodes;
+    std::vector<PlySummary> plies;
+};
+
+[[nodiscard]] static ReportOptions parse_options(int argc, char** argv) {
+    ReportOptions options;
+    for (int index = 1; index < argc; index++) {
+        std::string argument = argv[index];
+        bool has_value = index + 1 < argc;
+        if (argument == "--baseline" && has_value) {
+            options.baseline_path = argv[++index];
+        }
+        else if (argument == "--top" && has_value) {
+            options.top = std::stoul(argv[++index]);
+        }
+        else if (options.trace_path.empty() && !argument.starts_with("--")) {
+            options.trace_path = argument;
+        }
+        else {
+            options.trace_path.clear();
+            break;
+        }
+    }
+    if (options.trace_path.empty()) {
+        throw std::runtime_error("usage: search_trace_report <trace> [--baseline <trace>] [--top <n>]");
+    }
+    return options;
+}
+
+// records are in post-order, so the descendants of a record are the not yet claimed records
+// right before it with a higher ply: a stack of pending subtrees finds them in a single pass
+template <game_score Score>
+[[nodiscard]] static TraceAnalysis<Score> analyze_trace(const std::string& path) {
+    TraceAnalysis<Score> analysis { read_search_trace<Score>(path), {}, {} };
+    const auto& records = analysis.trace.records;
+    analysis.subtree_nodes.resize(records.size());
+    std::vector<size_t> pending;
+    for (size_t index = 0; index < records.size(); index++) {
+        const auto& record = records[index];
+        size_t nodes = 1;
+        while (!pending.empty() && records[pending.back()].ply > record.ply) {
+            nodes += analysis.subtree_nodes[pending.back()];
+            pending.pop_back();
+        }
+        analysis.subtree_nodes[index] = nodes;
+        pending.push_back(index);
+
+        if (record.ply >= analysis.plies.size()) {
+            analysis.plies.resize(record.ply + 1);
+        }
+        PlySummary& ply = analysis.plies[record.ply];
+        ply.nodes++;
+        ply.interior_nodes += (nodes > 1);
+        if (record.cutoff_order != SearchTraceRecord<Score>::NO_CUTOFF) {
+            ply.cutoffs++;
+            ply.first_child_cutoffs += (record.cutoff_order == 0);
+        }
+    }
+    return analysis;
+}
+
+[[nodiscard]] static double ratio(size_t numerator, size_t denominator) {
+    return (denominator == 0) ? 0.0 : static_cast<double>(numerator) / static_cast<double>(denominator);
+}
+
+static void print_plies(const std::vector<PlySummary>& plies, std::ostream& stream) {
+    stream << std::setw(5) << "ply" << std::setw(12) << "nodes" << std::setw(12) << "interior"
+           << std::setw(10) << "ebf" << std::setw(10) << "cutoffs" << std::setw(13) << "first-child" << "\n";
+    for (size_t ply = 1; ply < plies.size(); ply++) {
+        const PlySummary& summary = plies[ply];
+        double branching = ratio((ply + 1 < plies.size()) ? plies[ply + 1].nodes : 0, summary.interior_nodes);
+        stream << std::setw(5) << ply << std::setw(12) << summary.nodes << std::setw(12) << summary.interior_nodes
+               << std::setw(10) << std::fixed << std::setprecision(2) << branching
+               << std::setw(10) << summary.cutoffs
+               << std::setw(12) << std::setprecision(1) << 100 * ratio(summary.first_child_cutoffs, summary.cutoffs) << "%\n";
+    }
+}
+
+template <game_score Score>
+static void print_hottest_subtrees(const TraceAnalysis<Score>& analysis, size_t top, std::ostream& stream) {
+    const auto& records = analysis.trace.records;
+    std::vector<size_t> order(records.size());
+    for (size_t index = 0; index < order.size(); index++) {
+        order[index] = index;
+    }
+    size_t shown = std::min(top, order.size());
+    std::partial_sort(order.begin(), order.begin() + shown, order.end(), [&](size_t lhs, size_t rhs) {
+        return analysis.subtree_nodes[lhs] > analysis.subtree_nodes[rhs];
+    });
+    stream << "hottest subtrees:\n" << std::setw(5) << "ply" << std::setw(7) << "depth" << std::setw(20) << "hash"
+           << std::setw(12) << "nodes" << std::setw(9) << "share" << "  score [window]\n";
+    for (size_t position = 0; position < shown; position++) {
+        const auto& record = records[order[position]];
+        size_t nodes = analysis.subtree_nodes[order[position]];
+        stream << std::setw(5) << record.ply << std::setw(7) << record.depth
+               << "  " << std::hex << std::setfill('0') << std::setw(16) << record.hash << std::dec << std::setfill(' ')
+               << std::setw(12) << nodes
+               << std::setw(8) << std::fixed << std::setprecision(1) << 100 * ratio(nodes, records.size()) << "%"
+               << "  " << record.score << " [" << record.alpha << ", " << record.beta << "]\n";
+    }
+}
+
+template <game_score Score>
+static void print_report(const TraceAnalysis<Score>& analysis, size_t top, std::ostream& stream) {
+    stream << analysis.trace.records.size() << " nodes recorded";
+    if (analysis.trace.dropped_records != 0) {
+        stream << " (" << analysis.trace.dropped_records << " more dropped, past the tracer's capacity)";
+    }
+    stream << "\n";
+    print_plies(analysis.plies, stream);
+    print_hottest_subtrees(analysis, top, stream);
+}
+
+// subtrees are matched by position (hash and ply), summed over every time the position got
+// searched: hashes are all zero for boards that can't be hashed, which makes them unmatchable
+template <game_score Score>
+[[nodiscard]] static std::unordered_map<uint64_t, size_t> subtree_nodes_by_position(
+    const TraceAnalysis<Score>& analysis, size_t ply
+) {
+    std::unordered_map<uint64_t, size_t> nodes_by_position;
+    const auto& records = analysis.trace.records;
+    for (size_t index = 0; index < records.size(); index++) {
+        if (records[index].ply == ply && records[index].hash != 0) {
+            nodes_by_position[records[index].hash] += analysis.subtree_nodes[index];
+        }
+    }
+    return nodes_by_position;
+}
+
+template <game_score Score>
+static void print_diff(
+    const TraceAnalysis<Score>& baseline, const TraceAnalysis<Score>& analysis, size_t top, std::ostream& stream
+) {
+    stream << "\nnodes per ply, baseline -> trace:\n" << std::setw(5) << "ply" << std::setw(12) << "baseline"
+           << std::setw(12) << "trace" << std::setw(10) << "change" << std::setw(17) << "first-child" << "\n";
+    size_t ply_count = std::max(baseline.plies.size(), analysis.plies.size());
+    for (size_t ply = 1; ply < ply_count; ply++) {
+        PlySummary before = (ply < baseline.plies.size()) ? baseline.plies[ply] : PlySummary{};
+        PlySummary after = (ply < analysis.plies.size()) ? analysis.plies[ply] : PlySummary{};
+        double change = 100 * (ratio(after.nodes, before.nodes) - 1);
+        stream << std::setw(5) << ply << std::setw(12) << before.nodes << std::setw(12) << after.nodes
+               << std::setw(9) << std::fixed << std::setprecision(1) << change << "%"
+               << std::setw(8) << 100 * ratio(before.first_child_cutoffs, before.cutoffs) << "% -> "
+               << std::setw(5) << 100 * ratio(after.first_child_cutoffs, after.cutoffs) << "%\n";
+    }
+
+    struct Change {
+        size_t ply;
+        uint64_t hash;
+        long long before;
+        long long after;
+    };
+    std::vector<Change> changes;
+    for (size_t ply = 1; ply < ply_count; ply++) {
+        auto before = subtree_nodes_by_position(baseline, ply);
+        auto after = subtree_nodes_by_position(analysis, ply);
+        for (const auto& [hash, nodes] : after) {
+            auto found = before.find(hash);
+            changes.push_back(Change { ply, hash, (found == before.end()) ? 0 : static_cast<long long>(found->second),
+                                       static_cast<long long>(nodes) });
+        }
+        for (const auto& [hash, nodes] : before) {
+            if (!after.contains(hash)) {
+                changes.push_back(Change { ply, hash, static_cast<long long>(nodes), 0 });
+            }
+        }
+    }
+    size_t shown = std::min(top, changes.size());
+    std::partial_sort(changes.begin(), changes.begin() + shown, changes.end(), [](const Change& lhs, const Change& rhs) {
+        return std::abs(lhs.after - lhs.before) > std::abs(rhs.after - rhs.before);
+    });
+    stream << "largest subtree changes:\n" << std::setw(5) << "ply" << std::setw(20) << "hash"
+           << std::setw(12) << "baseline" << std::setw(12) << "trace" << "\n";
+    for (size_t position = 0; position < shown; position++) {
+        const Change& change = changes[position];
+        stream << std::setw(5) << change.ply
+               << "  " << std::hex << std::setfill('0') << std::setw(16) << change.hash << std::dec << std::setfill(' ')
+               << std::setw(12) << change.before << std::setw(12) << change.after << "\n";
+    }
+}
+
+template <game_score Score>
+static void report(const ReportOptions& options) {
+    TraceAnalysis<Score> analysis = analyze_trace<Score>(options.trace_path);
+    print_report(analysis, options.top, std::cout);
+    if (!options.baseline_path.empty()) {
+        TraceAnalysis<Score> baseline = analyze_trace<Score>(options.baseline_path);
+        print_diff(baseline, analysis, options.top, std::cout);
+    }
+}
+
+// the score type is only known from the header: integer scores are read back as signed
+int main(int argc, char** argv) {
+    try {
+        ReportOptions options = parse_options(argc, argv);
+        SearchTraceHeader header = read_search_trace_header(options.trace_path);
+        if (header.score_is_floating_point) {
+            (header.score_size == sizeof(float)) ? report<float>(options) : report<double>(options);
+        }
+        else {
+            (header.score_size == sizeof(int32_t)) ? report<int32_t>(options) : report<int64_t>(options);
+        }
+        return 0;
+    }
+    catch (const std::exception& error) {
+        std::cerr << error.what() << std::endl;
+        return 2;
+    }
+}